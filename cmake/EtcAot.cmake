@@ -0,0 +1,28 @@
+# Ahead-of-time compiled models, see include/CodeGen.h
+#
+#   etc_add_aot_library(<target> GENERATOR <executable> [ARGS <arg>...] [BYPRODUCTS <file>...])
+#
+# Runs GENERATOR, a program that builds a NeuralNetwork and writes it with
+# CodeGen::Write to the source path it gets as its first argument, followed by
+# ARGS. The emitted translation unit is built into shared library <target>.
+# BYPRODUCTS lists other files the generator writes, e.g. a weights file.
+set(ETC_INCLUDE_DIR ${CMAKE_CURRENT_LIST_DIR}/../include)
+
+function(etc_add_aot_library target)
+  cmake_parse_arguments(AOT "" "GENERATOR" "ARGS;BYPRODUCTS" ${ARGN})
+  if(NOT AOT_GENERATOR)
+    message(FATAL_ERROR "etc_add_aot_library(${target}) needs a GENERATOR")
+  endif()
+
+  set(source ${CMAKE_CURRENT_BINARY_DIR}/${target}.cc)
+  add_custom_command(
+    OUTPUT ${source}
+    BYPRODUCTS ${AOT_BYPRODUCTS}
+    COMMAND ${AOT_GENERATOR} ${source} ${AOT_ARGS}
+    DEPENDS ${AOT_GENERATOR}
+    COMMENT "Generating ${target}"
+  )
+
+  add_library(${target} SHARED ${source})
+  target_include_directories(${target} PRIVATE ${ETC_INCLUDE_DIR})
+endfunction()
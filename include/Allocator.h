@@ -0,0 +1,174 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#pragma once
+
+// Source of tensor storage. Buffers are at least kAlignment-aligned, so kernels
+// may use aligned SIMD loads on the first element.
+class Allocator {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    virtual ~Allocator() = default;
+
+    virtual void* Allocate(size_t bytes) = 0;
+
+    // bytes is the size the buffer was allocated with
+    virtual void Deallocate(void* ptr, size_t bytes) = 0;
+
+    // Allocator for tensors that are not given one: the shared PoolAllocator
+    // unless replaced; nullptr restores it. Tensors keep the allocator they were
+    // created with, which must outlive them.
+    static Allocator* Default() { return DefaultSlot().load(); }
+
+    static void SetDefault(Allocator* allocator);
+
+protected:
+    static size_t RoundUp(size_t x, size_t multiple) { return (x + multiple - 1) / multiple * multiple; }
+
+private:
+    static std::atomic<Allocator*>& DefaultSlot();
+};
+
+
+// Plain aligned heap memory. With huge pages, buffers of at least kHugePageSize are
+// placed on huge page boundaries and advised as transparent huge pages (Linux),
+// cutting TLB misses on large weights and activations.
+class AlignedAllocator : public Allocator {
+public:
+    static constexpr size_t kHugePageSize = 2 << 20;
+
+    explicit AlignedAllocator(bool huge_pages = false) : huge_pages_(huge_pages) {}
+
+    void* Allocate(size_t bytes) override {
+        const bool huge = huge_pages_ && bytes >= kHugePageSize;
+        const size_t alignment = huge ? kHugePageSize : kAlignment;
+        void* ptr = std::aligned_alloc(alignment, RoundUp(bytes, alignment));
+        if (!ptr) throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (huge) madvise(ptr, RoundUp(bytes, alignment), MADV_HUGEPAGE);
+#endif
+        return ptr;
+    }
+
+    void Deallocate(void* ptr, size_t) override { std::free(ptr); }
+
+    bool huge_pages() const { return huge_pages_; }
+
+    // Process-wide instances, never destroyed so late tensors can still free into them
+    static AlignedAllocator& Shared() {
+        static AlignedAllocator* allocator = new AlignedAllocator(false);
+        return *allocator;
+    }
+
+    static AlignedAllocator& SharedHugePages() {
+        static AlignedAllocator* allocator = new AlignedAllocator(true);
+        return *allocator;
+    }
+
+private:
+    bool huge_pages_;
+};
+
+
+// Keeps freed buffers in per-size-class free lists and hands them out again, so
+// the activations of repeated infer() calls stop going to malloc. Size classes
+// have four steps per power of two, wasting at most a quarter of a buffer.
+// Up to max_cached_bytes stay cached; anything beyond goes back upstream.
+class PoolAllocator : public Allocator {
+public:
+    explicit PoolAllocator(Allocator& upstream = AlignedAllocator::Shared(), size_t max_cached_bytes = size_t(1) << 30)
+        : upstream_(upstream), max_cached_bytes_(max_cached_bytes) {}
+
+    ~PoolAllocator() override { Release(); }
+
+    void* Allocate(size_t bytes) override {
+        const size_t size = SizeClass(bytes);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<void*>& free_list = free_lists_[size];
+            if (!free_list.empty()) {
+                void* ptr = free_list.back();
+                free_list.pop_back();
+                cached_bytes_ -= size;
+                hits_++;
+                return ptr;
+            }
+        }
+        return upstream_.Allocate(size);
+    }
+
+    void Deallocate(void* ptr, size_t bytes) override {
+        const size_t size = SizeClass(bytes);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cached_bytes_ + size <= max_cached_bytes_) {
+                free_lists_[size].push_back(ptr);
+                cached_bytes_ += size;
+                return;
+            }
+        }
+        upstream_.Deallocate(ptr, size);
+    }
+
+    // Returns every cached buffer upstream
+    void Release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [size, free_list] : free_lists_) {
+            for (void* ptr : free_list) upstream_.Deallocate(ptr, size);
+            free_list.clear();
+        }
+        cached_bytes_ = 0;
+    }
+
+    size_t cached_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cached_bytes_;
+    }
+
+    // Allocations served from the free lists
+    size_t hits() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+
+    static size_t SizeClass(size_t bytes) {
+        if (bytes <= kAlignment) return kAlignment;
+        size_t power = kAlignment;
+        while (power < bytes) power <<= 1;
+        return RoundUp(bytes, std::max(power / 8, kAlignment));
+    }
+
+    static PoolAllocator& Shared() {
+        static PoolAllocator* pool = new PoolAllocator();
+        return *pool;
+    }
+
+private:
+    Allocator& upstream_;
+    const size_t max_cached_bytes_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<size_t, std::vector<void*>> free_lists_;
+    size_t cached_bytes_ = 0;
+    size_t hits_ = 0;
+};
+
+
+inline std::atomic<Allocator*>& Allocator::DefaultSlot() {
+    static std::atomic<Allocator*> slot(&PoolAllocator::Shared());
+    return slot;
+}
+
+inline void Allocator::SetDefault(Allocator* allocator) {
+    DefaultSlot().store(allocator ? allocator : &PoolAllocator::Shared());
+}
@@ -0,0 +1,102 @@
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "ConvRow.h"
+#include "ConvKernelScalar.h"
+#include "ConvKernelAvx2.h"
+#include "ConvKernelAvx512.h"
+#include "FastMatMul.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+// Direct convolution over channel-blocked tensors (NCHW8c / NCHW16c, the kernel's
+// kLanes). A pixel's channel block is one vector, so each output pixel of a block
+// of output channels accumulates input value x weight vector FMAs with no
+// gathering or unfolding, and the input never leaves the blocked layout.
+//
+// Input channels are summed in ranges whose weights stay in L1 while a band of
+// rows is computed; tasks are (image, output block, band of rows).
+template <typename Kernel>
+class BlockedConv {
+public:
+    static constexpr size_t kLanes = Kernel::kLanes;
+    static constexpr size_t kRowsPerTask = 4;
+    static constexpr size_t kWeightFloats = 4096; // per channel range, 16 KiB
+
+    // [out block][kh][kw][in_channels][lanes] from OIHW weights, padding lanes zero;
+    // reusable for every input of the layer
+    static std::vector<float> TransformWeights(
+        const float *weights, size_t out_channels, size_t in_channels, size_t kernel_height, size_t kernel_width
+    ) {
+        const size_t blocks = (out_channels + kLanes - 1) / kLanes;
+        const size_t taps = kernel_height * kernel_width;
+        std::vector<float> transformed(blocks * taps * in_channels * kLanes, 0.0f);
+        for (size_t oc = 0; oc < out_channels; ++oc)
+            for (size_t ic = 0; ic < in_channels; ++ic)
+                for (size_t tap = 0; tap < taps; ++tap)
+                    transformed[((oc / kLanes * taps + tap) * in_channels + ic) * kLanes + oc % kLanes] =
+                        weights[(oc * in_channels + ic) * taps + tap];
+        return transformed;
+    }
+
+    // input (batch, in_channels, height, width) and output (batch, out_channels,
+    // out_height, out_width) both blocked by kLanes; addend (may be null) is laid
+    // out like the output, or with per_channel holds one value per output channel
+    // (blocked, so padded to whole blocks), and forms the fused epilogue with relu.
+    static void Run(
+        const float *input, size_t batch, size_t in_channels, size_t height, size_t width,
+        const float *weights, size_t out_channels, size_t kernel_height, size_t kernel_width,
+        size_t stride, size_t padding,
+        float *output, const float *addend = nullptr, bool relu = false, bool per_channel = false
+    ) {
+        const size_t out_height = (height + 2 * padding - kernel_height) / stride + 1;
+        const size_t out_width = (width + 2 * padding - kernel_width) / stride + 1;
+        const size_t in_blocks = (in_channels + kLanes - 1) / kLanes;
+        const size_t out_blocks = (out_channels + kLanes - 1) / kLanes;
+        const size_t taps = kernel_height * kernel_width;
+        const size_t channel_range = std::max<size_t>(1, kWeightFloats / (taps * kLanes));
+        const size_t bands = (out_height + kRowsPerTask - 1) / kRowsPerTask;
+
+        ThreadPool::Shared().ParallelFor(batch * out_blocks * bands, [&](size_t task) {
+            const size_t band = task % bands;
+            const size_t block = task / bands % out_blocks;
+            const size_t b = task / bands / out_blocks;
+            const size_t plane = (b * out_blocks + block) * out_height * out_width * kLanes;
+
+            ConvRow row;
+            row.input = input + b * in_blocks * height * width * kLanes;
+            row.height = height;
+            row.width = width;
+            row.in_channels = in_channels;
+            row.weights = weights + block * taps * in_channels * kLanes;
+            row.kernel_height = kernel_height;
+            row.kernel_width = kernel_width;
+            row.stride = stride;
+            row.padding = padding;
+            row.out_width = out_width;
+
+            // Rows of the epilogue are the block's channels, columns its pixels
+            GemmEpilogue epilogue;
+            epilogue.ld_addend = per_channel ? 0 : kLanes;
+            epilogue.relu = relu;
+            const bool has_epilogue = addend || relu;
+
+            const size_t row_end = std::min(out_height, (band + 1) * kRowsPerTask);
+            for (size_t c0 = 0; c0 < in_channels || c0 == 0; c0 += channel_range) {
+                row.channel_begin = c0;
+                row.channel_end = std::min(in_channels, c0 + channel_range);
+                row.accumulate = c0 > 0;
+                const bool last = row.channel_end == in_channels;
+                for (size_t oh = band * kRowsPerTask; oh < row_end; ++oh) {
+                    const size_t offset = plane + oh * out_width * kLanes;
+                    row.out_row = oh;
+                    row.output = output + offset;
+                    epilogue.addend = !addend ? nullptr : per_channel ? addend + block * kLanes : addend + offset;
+                    row.epilogue = last && has_epilogue ? &epilogue : nullptr;
+                    Kernel::Run(row);
+                }
+            }
+        }, FastMatMul::GetNumThreads());
+    }
+};
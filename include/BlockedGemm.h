@@ -0,0 +1,311 @@
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "ThreadPool.h"
+#include "GemmEpilogue.h"
+#include "HalfConvert.h"
+
+#pragma once
+
+// GotoBLAS/BLIS-style driver: C(n x m) = A(n x k) * B(k x m), C column-major.
+// A and B are addressed through row/column strides, so transposed or
+// row-major operands need no copy before the call.
+//
+// Loop nest (outermost first):
+//   jc: NC columns of C   -> B block sized for L3
+//   pc: KC depth          -> pack B[pc:pc+KC, jc:jc+NC] into NR-wide micro-panels
+//   ic: MC rows of C      -> pack A[ic:ic+MC, pc:pc+KC] into MR-tall micro-panels (L2)
+//   jr, ir: MR x NR micro-tiles, computed by Kernel::MicroKernel in registers
+//
+// With num_threads > 1 the packed B block is shared, and the (ic, jr) tile space of
+// each KC step is split into tasks on the shared ThreadPool; every thread packs
+// its own A block.
+//
+// An optional epilogue (addend, ReLU) is applied by the micro-kernel on the last
+// KC block, while the finished tile is still in registers.
+//
+// Kernel provides kMR, kNR, kMC, kKC, kNC and
+//   MicroKernel(kc, a_panel, b_panel, c, ldc, accumulate, epilogue)
+//
+// A can also come from a packing source instead of memory (see StridedMatrix),
+// e.g. convolution patches gathered straight from the input image.
+
+// A operand read through strides: element (i, p) at data[i * rs + p * cs].
+// Sources pack rows [i0, i0 + mc) x depth [p0, p0 + kc) into MR-row micro-panels,
+// each stored k-major (panel[p * MR + i]), zero-filling rows past mc.
+struct StridedMatrix {
+    const float *data;
+    size_t rs;
+    size_t cs;
+
+    template <size_t MR>
+    void Pack(size_t i0, size_t mc, size_t p0, size_t kc, float *buffer) const {
+        const float *A = data + i0 * rs + p0 * cs;
+        for (size_t ir = 0; ir < mc; ir += MR) {
+            const size_t mr = std::min(MR, mc - ir);
+            const float *a = A + ir * rs;
+            for (size_t p = 0; p < kc; ++p) {
+                for (size_t i = 0; i < mr; ++i) buffer[i] = a[i * rs + p * cs];
+                for (size_t i = mr; i < MR; ++i) buffer[i] = 0.0f;
+                buffer += MR;
+            }
+        }
+    }
+};
+
+// StridedMatrix over bf16/f16 storage, widened to float while packing
+struct HalfStridedMatrix {
+    const uint16_t *data;
+    size_t rs;
+    size_t cs;
+    DType dtype;
+
+    template <size_t MR>
+    void Pack(size_t i0, size_t mc, size_t p0, size_t kc, float *buffer) const {
+        const uint16_t *A = data + i0 * rs + p0 * cs;
+        for (size_t ir = 0; ir < mc; ir += MR) {
+            const size_t mr = std::min(MR, mc - ir);
+            const uint16_t *a = A + ir * rs;
+            for (size_t p = 0; p < kc; ++p) {
+                if (rs == 1) HalfConvert::ToFloat(dtype, a + p * cs, buffer, mr);
+                else for (size_t i = 0; i < mr; ++i) buffer[i] = half::ToFloat(dtype, a[i * rs + p * cs]);
+                for (size_t i = mr; i < MR; ++i) buffer[i] = 0.0f;
+                buffer += MR;
+            }
+        }
+    }
+};
+
+// Prepacked B for RunPacked. Block(offset, count) returns count floats of
+// packed panels starting at offset.
+struct PackedPanels {
+    const float *data;
+
+    const float *Block(size_t offset, size_t) const { return data + offset; }
+};
+
+// Panels stored as bf16/f16, widened one KC x NC block at a time into a
+// per-thread buffer. The conversion is shared by every micro-tile of an MC-row
+// block, so it costs about 1/MC of the block's multiply-adds.
+struct HalfPackedPanels {
+    const uint16_t *data;
+    DType dtype;
+
+    const float *Block(size_t offset, size_t count) const {
+        thread_local std::vector<float> buffer;
+        buffer.resize(count);
+        HalfConvert::ToFloat(dtype, data + offset, buffer.data(), count);
+        return buffer.data();
+    }
+};
+
+template <typename Kernel>
+class BlockedGemm {
+public:
+    static constexpr size_t kMR = Kernel::kMR;
+    static constexpr size_t kNR = Kernel::kNR;
+    static constexpr size_t kMC = Kernel::kMC;
+    static constexpr size_t kKC = Kernel::kKC;
+    static constexpr size_t kNC = Kernel::kNC;
+
+    static void Run(
+        size_t n, size_t m, size_t k,
+        const float *A, size_t rsa, size_t csa,
+        const float *B, size_t rsb, size_t csb,
+        float *C, size_t ldc,
+        size_t num_threads = 1,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        Run(n, m, k, StridedMatrix{A, rsa, csa}, B, rsb, csb, C, ldc, num_threads, epilogue);
+    }
+
+    template <typename ASource>
+    static void Run(
+        size_t n, size_t m, size_t k,
+        const ASource &A,
+        const float *B, size_t rsb, size_t csb,
+        float *C, size_t ldc,
+        size_t num_threads = 1,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        ThreadPool& pool = ThreadPool::Shared();
+        num_threads = std::max<size_t>(1, std::min(num_threads, pool.NumThreads()));
+
+        thread_local std::vector<float> b_buffer;
+        b_buffer.resize(kKC * RoundUp(std::min(m, kNC), kNR));
+        float *b_packed = b_buffer.data();
+
+        for (size_t jc = 0; jc < m; jc += kNC) {
+            const size_t nc = std::min(kNC, m - jc);
+            const size_t panels = (nc + kNR - 1) / kNR;
+
+            // Split the columns so that every thread gets at least one task
+            const size_t row_blocks = (n + kMC - 1) / kMC;
+            const size_t col_chunks = std::min(panels, (num_threads + row_blocks - 1) / row_blocks);
+            const size_t chunk_cols = RoundUp((nc + col_chunks - 1) / col_chunks, kNR);
+
+            for (size_t pc = 0; pc < k; pc += kKC) {
+                const size_t kc = std::min(kKC, k - pc);
+                // First depth block overwrites C, later ones accumulate into it
+                const bool accumulate = pc != 0;
+                const bool last = pc + kc == k;
+
+                pool.ParallelFor(col_chunks, [&](size_t chunk) {
+                    const size_t c0 = chunk * chunk_cols;
+                    if (c0 >= nc) return;
+                    PackB(kc, std::min(chunk_cols, nc - c0), B + pc * rsb + (jc + c0) * csb, rsb, csb,
+                          b_packed + c0 * kc);
+                }, num_threads);
+
+                pool.ParallelFor(row_blocks * col_chunks, [&](size_t task) {
+                    const size_t ic = (task / col_chunks) * kMC;
+                    const size_t c0 = (task % col_chunks) * chunk_cols;
+                    if (c0 >= nc) return;
+
+                    GemmEpilogue block_epilogue;
+                    if (last && epilogue) block_epilogue = epilogue->Offset(ic, jc + c0);
+
+                    ComputeBlock(A, ic, std::min(kMC, n - ic), pc, kc, b_packed + c0 * kc, std::min(chunk_cols, nc - c0),
+                                 C + ic + (jc + c0) * ldc, ldc, accumulate, last && epilogue ? &block_epilogue : nullptr);
+                }, num_threads);
+            }
+        }
+    }
+
+    // Floats Prepack writes for a k x m B
+    static size_t PackedSize(size_t k, size_t m) { return k * RoundUp(m, kNR); }
+
+    // B packed once, ahead of RunPacked: the micro-panels Run builds for every NC
+    // column block and KC depth block, block (jc, pc) at jc * k + pc * RoundUp(nc, NR)
+    static void Prepack(size_t k, size_t m, const float *B, size_t rsb, size_t csb, float *packed) {
+        for (size_t jc = 0; jc < m; jc += kNC) {
+            const size_t nc = std::min(kNC, m - jc);
+            for (size_t pc = 0; pc < k; pc += kKC) {
+                PackB(std::min(kKC, k - pc), nc, B + pc * rsb + jc * csb, rsb, csb, packed + jc * k + pc * RoundUp(nc, kNR));
+            }
+        }
+    }
+
+    // batch GEMMs C_b(n x m) = A_b * B_b over prepacked B: a_of(b) returns the A
+    // source of item b, B_b starts at b_packed + b * batch_stride_b (0 shares one B),
+    // b_packed being PackedPanels or HalfPackedPanels
+    // and C_b at C + b * batch_stride_c. The (item, row block, column chunk) tiles
+    // of a KC step form one task space, so small per-item GEMMs still fill every
+    // thread. An epilogue addend follows C's strides, a per-column bias
+    // (rs_addend 0) is shared by every item. Needs k > 0.
+    template <typename ABatch, typename Panels>
+    static void RunPacked(
+        size_t batch, size_t n, size_t m, size_t k,
+        const ABatch &a_of, const Panels &b_packed, size_t batch_stride_b,
+        float *C, size_t ldc, size_t batch_stride_c,
+        size_t num_threads = 1,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        ThreadPool& pool = ThreadPool::Shared();
+        num_threads = std::max<size_t>(1, std::min(num_threads, pool.NumThreads()));
+
+        const size_t row_blocks = (n + kMC - 1) / kMC;
+        const size_t tiles = batch * row_blocks;
+        if (tiles == 0) return;
+
+        for (size_t jc = 0; jc < m; jc += kNC) {
+            const size_t nc = std::min(kNC, m - jc);
+            const size_t panels = (nc + kNR - 1) / kNR;
+            const size_t col_chunks = std::min(panels, (num_threads + tiles - 1) / tiles);
+            const size_t chunk_cols = RoundUp((nc + col_chunks - 1) / col_chunks, kNR);
+
+            for (size_t pc = 0; pc < k; pc += kKC) {
+                const size_t kc = std::min(kKC, k - pc);
+                const bool accumulate = pc != 0;
+                const bool last = pc + kc == k;
+                const size_t block = jc * k + pc * RoundUp(nc, kNR);
+
+                pool.ParallelFor(tiles * col_chunks, [&](size_t task) {
+                    const size_t b = task / (row_blocks * col_chunks);
+                    const size_t ic = (task / col_chunks % row_blocks) * kMC;
+                    const size_t c0 = (task % col_chunks) * chunk_cols;
+                    if (c0 >= nc) return;
+
+                    // Item b's C starts b * batch_stride_c elements further, taken as
+                    // rows so that a per-column bias stays shared
+                    GemmEpilogue block_epilogue;
+                    if (last && epilogue) block_epilogue = epilogue->Offset(b * batch_stride_c + ic, jc + c0);
+
+                    const size_t cols = std::min(chunk_cols, nc - c0);
+                    const float *b_block = b_packed.Block(b * batch_stride_b + block + c0 * kc, RoundUp(cols, kNR) * kc);
+                    ComputeBlock(a_of(b), ic, std::min(kMC, n - ic), pc, kc, b_block, cols,
+                                 C + b * batch_stride_c + ic + (jc + c0) * ldc, ldc, accumulate,
+                                 last && epilogue ? &block_epilogue : nullptr);
+                }, num_threads);
+            }
+        }
+    }
+
+private:
+    static size_t RoundUp(size_t x, size_t multiple) {
+        return (x + multiple - 1) / multiple * multiple;
+    }
+
+    // Packs rows [ic, ic + mc) of A for one KC step and runs their micro-tiles
+    // against cols columns of packed B
+    template <typename ASource>
+    static void ComputeBlock(
+        const ASource &A, size_t ic, size_t mc, size_t pc, size_t kc,
+        const float *b_packed, size_t cols,
+        float *C, size_t ldc, bool accumulate,
+        const GemmEpilogue *epilogue
+    ) {
+        thread_local std::vector<float> a_buffer;
+        a_buffer.resize(kMC * kKC);
+        A.template Pack<kMR>(ic, mc, pc, kc, a_buffer.data());
+        MacroKernel(mc, cols, kc, a_buffer.data(), b_packed, C, ldc, accumulate, epilogue);
+    }
+
+    // B block -> NR-column micro-panels, each stored k-major: panel[p * NR + j]
+    static void PackB(size_t kc, size_t nc, const float *B, size_t rsb, size_t csb, float *buffer) {
+        for (size_t jr = 0; jr < nc; jr += kNR) {
+            const size_t nr = std::min(kNR, nc - jr);
+            const float *b = B + jr * csb;
+            for (size_t p = 0; p < kc; ++p) {
+                for (size_t j = 0; j < nr; ++j) buffer[j] = b[p * rsb + j * csb];
+                for (size_t j = nr; j < kNR; ++j) buffer[j] = 0.0f;
+                buffer += kNR;
+            }
+        }
+    }
+
+    static void MacroKernel(
+        size_t mc, size_t nc, size_t kc,
+        const float *a_packed, const float *b_packed,
+        float *C, size_t ldc, bool accumulate,
+        const GemmEpilogue *epilogue
+    ) {
+        for (size_t jr = 0; jr < nc; jr += kNR) {
+            const size_t nr = std::min(kNR, nc - jr);
+            const float *b_panel = b_packed + jr * kc;
+
+            for (size_t ir = 0; ir < mc; ir += kMR) {
+                const size_t mr = std::min(kMR, mc - ir);
+                const float *a_panel = a_packed + ir * kc;
+                float *c = C + ir + jr * ldc;
+
+                if (mr == kMR && nr == kNR) {
+                    GemmEpilogue tile_epilogue;
+                    if (epilogue) tile_epilogue = epilogue->Offset(ir, jr);
+                    Kernel::MicroKernel(kc, a_panel, b_panel, c, ldc, accumulate, epilogue ? &tile_epilogue : nullptr);
+                    continue;
+                }
+
+                // Edge tile: compute the full micro-tile aside, then copy the valid part
+                alignas(64) float tile[kMR * kNR];
+                Kernel::MicroKernel(kc, a_panel, b_panel, tile, kMR, false);
+                for (size_t j = 0; j < nr; ++j) {
+                    for (size_t i = 0; i < mr; ++i) {
+                        float value = accumulate ? c[i + j * ldc] + tile[i + j * kMR] : tile[i + j * kMR];
+                        c[i + j * ldc] = epilogue ? epilogue->Apply(value, ir + i, jr + j) : value;
+                    }
+                }
+            }
+        }
+    }
+};
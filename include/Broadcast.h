@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include "Layout.h"
+
+#pragma once
+
+// NumPy-style broadcasting for the elementwise operations. Shapes align at
+// their last dimension; each pair of dimensions must be equal or contain a 1,
+// and a missing leading dimension counts as 1. A broadcast operand is never
+// expanded: kernels read it with stride 0 along the dimensions it lacks, so a
+// [1, C, 1, 1] bias costs C floats.
+
+// Shape the two operands broadcast to; throws std::invalid_argument(error) if
+// they cannot be broadcast together
+inline std::vector<size_t> BroadcastShape(const std::vector<size_t>& a, const std::vector<size_t>& b, const std::string& error) {
+    const size_t rank = std::max(a.size(), b.size());
+    std::vector<size_t> shape(rank);
+    for (size_t d = 0; d < rank; ++d) {
+        const size_t da = d + a.size() >= rank ? a[d + a.size() - rank] : 1;
+        const size_t db = d + b.size() >= rank ? b[d + b.size() - rank] : 1;
+        if (da != db && da != 1 && db != 1) throw std::invalid_argument(error);
+        shape[d] = da == 1 ? db : da;
+    }
+    return shape;
+}
+
+// Dimensions of a tensor's storage, outermost first: the shape itself for NCHW,
+// {N, H, W, C} for NHWC and {N, C / lanes, H, W, lanes} for the blocked layouts,
+// padding lanes included
+inline std::vector<size_t> StorageDims(const std::vector<size_t>& shape, Layout layout) {
+    if (layout == Layout::NCHW) return shape;
+    if (shape.size() != 4) throw std::invalid_argument(std::string(LayoutName(layout)) + " needs a rank-4 shape");
+    if (layout == Layout::NHWC) return {shape[0], shape[2], shape[3], shape[1]};
+    const size_t lanes = ChannelBlock(layout);
+    return {shape[0], (shape[1] + lanes - 1) / lanes, shape[2], shape[3], lanes};
+}
+
+// Element strides of an operand, stored in layout, along the StorageDims of the
+// output shape it broadcasts to; 0 along every dimension it is broadcast over.
+// A blocked operand with one channel is broadcast over the lanes too, which also
+// fills the output's padding lanes.
+inline std::vector<size_t> BroadcastStrides(const std::vector<size_t>& shape, const std::vector<size_t>& out_shape, Layout layout) {
+    if (shape.size() > out_shape.size()) throw std::invalid_argument("Operand has more dimensions than the broadcast result");
+    std::vector<size_t> padded(out_shape.size() - shape.size(), 1);
+    padded.insert(padded.end(), shape.begin(), shape.end());
+
+    const std::vector<size_t> dims = StorageDims(padded, layout);
+    const std::vector<size_t> out_dims = StorageDims(out_shape, layout);
+    std::vector<size_t> strides(dims.size());
+    size_t stride = 1;
+    for (size_t d = dims.size(); d-- > 0;) {
+        // Lanes hold one valid value for a single-channel operand
+        const bool lanes = IsBlocked(layout) && d == dims.size() - 1;
+        const size_t extent = lanes && padded[1] == 1 ? 1 : dims[d];
+        if (extent == out_dims[d]) strides[d] = stride;
+        else if (extent == 1) strides[d] = 0;
+        else throw std::invalid_argument("Operand shape does not broadcast to the result shape");
+        stride *= dims[d];
+    }
+    return strides;
+}
@@ -0,0 +1,58 @@
+#include "Executor.h"
+#include "QuantizedTensor.h"
+#include <limits>
+
+#pragma once
+
+// Post-training calibration for the int8 paths: runs the graph in fp32 on
+// sample inputs, records the range of the activations (lhs operand) of every
+// Quantizable operation, and switches each one to int8 with parameters
+// covering its range.
+class Calibrator {
+public:
+    // input takes each sample in turn and gets its tensor back afterwards.
+    // Returns the number of operations quantized.
+    static size_t Calibrate(INode* output, InputData& input, const std::vector<Tensor>& samples) {
+        if (samples.empty()) throw std::invalid_argument("Calibration needs at least one sample input");
+        const Executor graph({output});
+
+        std::vector<Quantizable*> targets;
+        std::vector<INode*> activations;
+        for (const Executor::Step& step : graph.schedule()) {
+            Quantizable* target = dynamic_cast<Quantizable*>(step.node);
+            const BinaryOperation* operation = dynamic_cast<const BinaryOperation*>(step.node);
+            if (!target || !operation || operation->lhsTensor() || step.nodeInputs() == 0) continue;
+            // Ranges are those of the fp32 graph, not of an earlier calibration
+            target->clearQuantization();
+            targets.push_back(target);
+            activations.push_back(graph.schedule()[step.inputs[0]].node);
+        }
+        if (targets.empty()) return 0;
+
+        std::vector<float> min(targets.size(), std::numeric_limits<float>::max());
+        std::vector<float> max(targets.size(), std::numeric_limits<float>::lowest());
+        const Tensor original = *input.value();
+        const Executor probe(activations);
+        try {
+            for (const Tensor& sample : samples) {
+                input.setTensor(sample);
+                const std::vector<Tensor> values = probe.run();
+                for (size_t i = 0; i < values.size(); ++i) {
+                    const Tensor value = values[i].toDType(DType::F32);
+                    const float* data = value.data();
+                    for (size_t j = 0; j < value.size(); ++j) {
+                        min[i] = std::min(min[i], data[j]);
+                        max[i] = std::max(max[i], data[j]);
+                    }
+                }
+            }
+        } catch (...) {
+            input.setTensor(original);
+            throw;
+        }
+        input.setTensor(original);
+
+        for (size_t i = 0; i < targets.size(); ++i) targets[i]->setQuantization(QuantParams::FromRange(min[i], max[i]));
+        return targets.size();
+    }
+};
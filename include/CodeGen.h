@@ -0,0 +1,360 @@
+#include "NeuralNetwork.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#pragma once
+
+// Ahead-of-time compilation of a NeuralNetwork into one standalone C++
+// translation unit, built against these headers (see cmake/EtcAot.cmake).
+// The graph is scheduled, fused and laid out like compile() does, then every
+// step is emitted as its own statement with static shapes and constant arena
+// offsets from the memory plan: f32 elementwise ops and ReLU become direct
+// kernel calls, other ops call an operation object of their exact type (no
+// virtual dispatch), which keeps its algorithm choice and packed weights.
+// Constant tensors are embedded in the source, or with Options::weights_file
+// written to that file and mapped on first call.
+//
+// The generated code exports, with C linkage:
+//   void <function>(const float* const* inputs, float* output);
+//   size_t <function>_output_size();
+// inputs are the graph inputs (InputData) in schedule order, NCHW f32 of the
+// shapes they had when generating; output gets the NCHW result. Calls from
+// different threads are independent; each thread keeps its own arena.
+class CodeGen {
+public:
+    struct Options {
+        std::string function = "etc_model"; // exported entry point
+        std::string weights_file;           // empty: weights embedded in the source
+    };
+
+    static std::string Emit(const NeuralNetwork& network) { return Emit(network, Options()); }
+
+    static std::string Emit(const NeuralNetwork& network, const Options& options) {
+        Unit unit(network.schedule(), options);
+        return unit.source();
+    }
+
+    // Writes the source to path, and the weights file when one is set
+    static void Write(const NeuralNetwork& network, const std::string& path) { Write(network, path, Options()); }
+
+    static void Write(const NeuralNetwork& network, const std::string& path, const Options& options) {
+        Unit unit(network.schedule(), options);
+        std::ofstream source(path, std::ios::trunc);
+        source << unit.source();
+        if (!source) throw std::runtime_error("Cannot write " + path);
+        if (!options.weights_file.empty()) unit.writeWeights(options.weights_file);
+    }
+
+private:
+    static constexpr size_t kAlignment = 64; // bytes, of every weight
+
+    class Unit {
+    public:
+        Unit(Executor executor, const Options& options) : executor_(std::move(executor)), options_(options) {
+            plan_ = MemoryPlanner::Plan(executor_);
+            const std::vector<Executor::Step>& schedule = executor_.schedule();
+
+            state_ << "    Tensor arena = Tensor(std::vector<size_t>{" << plan_.arena_size << "}, Tensor::Uninitialized());\n";
+            for (size_t i = 0; i < schedule.size(); ++i) {
+                const Executor::Step& step = schedule[i];
+                if (step.skipped) continue;
+                if (const Tensor* held = step.node->value()) {
+                    if (held->dtype() != DType::F32 || held->layout() != Layout::NCHW)
+                        throw std::invalid_argument("Generated code takes NCHW f32 inputs");
+                    inputs_[i] = input_shapes_.size();
+                    input_shapes_.push_back(held->shape());
+                    continue;
+                }
+                state_ << "    Tensor t" << i << " = Tensor::Wrap(" << Shape(plan_.shapes[i]) << ", arena.data() + "
+                       << plan_.offsets[i] << ", " << LayoutExpr(plan_.layouts[i]) << ");\n";
+                body_ << "    // " << i << ": " << KindName(step.node->kind()) << " -> " << Shape(plan_.shapes[i]) << "\n";
+                if (!emitDirect(i)) emitOperation(i);
+            }
+
+            const size_t output = executor_.outputs().front();
+            output_size_ = 1;
+            for (size_t dim : plan_.shapes[output]) output_size_ *= dim;
+            if (inputs_.count(output)) {
+                body_ << "    std::copy(inputs[" << inputs_.at(output) << "], inputs[" << inputs_.at(output) << "] + " << output_size_ << ", output);\n";
+            } else if (plan_.layouts[output] == Layout::NCHW) {
+                body_ << "    std::copy(arena + " << plan_.offsets[output] << ", arena + " << plan_.offsets[output] + output_size_ << ", output);\n";
+            } else {
+                body_ << "    Reorder(arena + " << plan_.offsets[output] << ", " << LayoutExpr(plan_.layouts[output])
+                      << ", output, Layout::NCHW, " << Shape(plan_.shapes[output]) << ");\n";
+            }
+        }
+
+        std::string source() const {
+            std::ostringstream out;
+            out << "// Generated by CodeGen from a NeuralNetwork, do not edit\n"
+                << "#include \"NeuralNetwork.h\"\n";
+            if (mapped()) out << "#include \"ModelFile.h\"\n";
+            out << "\nnamespace {\n\n" << weights_.str();
+            if (mapped()) {
+                out << "const unsigned char* MapWeights() {\n"
+                    << "    static const MappedFile file(" << Quote(options_.weights_file) << ");\n"
+                    << "    if (file.size() != " << blob_.size() << ") throw std::runtime_error(\"The weights file does not match the generated code\");\n"
+                    << "    return file.data();\n"
+                    << "}\n\n";
+            }
+            out << "std::shared_ptr<INode> Placeholder() { return std::make_shared<InputData>(Tensor()); }\n\n"
+                << "// Weights are only read, the storage may be read-only\n"
+                << "Tensor Constant(const std::vector<size_t>& shape, DType dtype, const void* data, Layout layout) {\n"
+                << "    return Tensor::Wrap(shape, dtype, const_cast<void*>(data), layout);\n"
+                << "}\n\n"
+                << "// Operations and constants, shared by every call\n"
+                << "struct Model {\n";
+            if (mapped()) out << "    const unsigned char* weights = MapWeights();\n";
+            out << model_.str()
+                << "\n    Model() {\n" << model_init_.str() << "    }\n"
+                << "};\n\n"
+                << "// Arena and the intermediate results in it, one per thread\n"
+                << "struct State {\n" << state_.str() << "};\n\n"
+                << "} // namespace\n\n";
+
+            out << "// Inputs:";
+            for (const std::vector<size_t>& shape : input_shapes_) out << " " << Shape(shape);
+            out << "\nextern \"C\" void " << options_.function << "(const float* const* inputs, float* output) {\n"
+                << "    static const Model m;\n"
+                << "    thread_local State s;\n"
+                << "    float* const arena = s.arena.data();\n"
+                << "    (void)arena;\n";
+            for (size_t k = 0; k < input_shapes_.size(); ++k) {
+                if (!wrapped_inputs_.count(k)) continue;
+                out << "    const Tensor in" << k << " = Tensor::Wrap(" << Shape(input_shapes_[k]) << ", const_cast<float*>(inputs[" << k << "]));\n";
+            }
+            out << body_.str() << "}\n\n"
+                << "extern \"C\" size_t " << options_.function << "_output_size() { return " << output_size_ << "; }\n";
+            return out.str();
+        }
+
+        void writeWeights(const std::string& path) const {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(blob_.data(), blob_.size());
+            if (!file) throw std::runtime_error("Cannot write " + path);
+        }
+
+    private:
+        Executor executor_;
+        Options options_;
+        MemoryPlan plan_;
+        std::ostringstream weights_, model_, model_init_, state_, body_;
+        std::unordered_map<size_t, size_t> inputs_;                 // schedule position -> input index
+        std::vector<std::vector<size_t>> input_shapes_;
+        std::unordered_map<size_t, bool> wrapped_inputs_;           // inputs read as tensors
+        std::unordered_map<const Tensor*, size_t> constants_;       // weight -> array index or file offset
+        std::unordered_map<const Tensor*, std::string> members_;    // weight -> Model member
+        std::vector<char> blob_;
+        size_t output_size_ = 0;
+
+        bool mapped() const { return !options_.weights_file.empty(); }
+
+        // Typed pointer to a weight's elements, for code inside Model or not
+        std::string weight(const Tensor& tensor, bool in_model) {
+            auto found = constants_.find(&tensor);
+            if (found == constants_.end()) {
+                size_t id = constants_.size();
+                if (mapped()) {
+                    // Offset in the weights file
+                    id = blob_.size();
+                    const size_t bytes = tensor.size() * DTypeSize(tensor.dtype());
+                    const char* data = tensor.dtype() == DType::F32 ? reinterpret_cast<const char*>(tensor.data())
+                                                                   : reinterpret_cast<const char*>(tensor.halfData());
+                    blob_.insert(blob_.end(), data, data + bytes);
+                    blob_.resize((blob_.size() + kAlignment - 1) / kAlignment * kAlignment, 0);
+                } else {
+                    EmitArray(weights_, "kWeights" + std::to_string(id), tensor);
+                }
+                found = constants_.emplace(&tensor, id).first;
+            }
+            if (!mapped()) return "kWeights" + std::to_string(found->second);
+            return std::string("reinterpret_cast<const ") + (tensor.dtype() == DType::F32 ? "float" : "uint16_t") + "*>(" +
+                   (in_model ? "weights + " : "m.weights + ") + std::to_string(found->second) + ")";
+        }
+
+        std::string constantTensor(const Tensor& tensor) {
+            return "Constant(" + Shape(tensor.shape()) + ", " + DTypeExpr(tensor.dtype()) + ", " + weight(tensor, true) +
+                   ", " + LayoutExpr(tensor.layout()) + ")";
+        }
+
+        // Model member holding a weight as a Tensor, e.g. for an epilogue addend
+        std::string member(const Tensor& tensor) {
+            auto found = members_.find(&tensor);
+            if (found != members_.end()) return found->second;
+            const std::string name = "w" + std::to_string(members_.size());
+            model_ << "    const Tensor " << name << " = " << constantTensor(tensor) << ";\n";
+            return members_.emplace(&tensor, "m." + name).first->second;
+        }
+
+        // Result of a step as a Tensor expression
+        std::string tensor(size_t pos) {
+            if (!inputs_.count(pos)) return "s.t" + std::to_string(pos);
+            wrapped_inputs_[inputs_.at(pos)] = true;
+            return "in" + std::to_string(inputs_.at(pos));
+        }
+
+        // Direct kernel call for same-layout f32 elementwise ops and ReLU, like
+        // ExecutionPlan; false when the step needs its operation
+        bool emitDirect(size_t i) {
+            const Executor::Step& step = executor_.schedule()[i];
+            const OpKind kind = step.node->kind();
+            const size_t size = StorageSize(plan_.shapes[i], plan_.layouts[i]);
+            if (step.addend || step.addend_is_input || step.relu || size == 0) return false;
+
+            // Pointer to an operand stored exactly like the output, or empty
+            const auto operand = [&](const Tensor* constant, size_t pos) -> std::string {
+                if (constant) {
+                    if (constant->dtype() != DType::F32 || constant->shape() != plan_.shapes[i] || constant->layout() != plan_.layouts[i]) return "";
+                    return weight(*constant, false);
+                }
+                if (plan_.shapes[pos] != plan_.shapes[i] || plan_.layouts[pos] != plan_.layouts[i]) return "";
+                if (inputs_.count(pos)) return "inputs[" + std::to_string(inputs_.at(pos)) + "]";
+                return "arena + " + std::to_string(plan_.offsets[pos]);
+            };
+            const std::string out = "arena + " + std::to_string(plan_.offsets[i]);
+
+            if (kind == OpKind::ReLU && step.inputs.size() == 1) {
+                const std::string in = operand(nullptr, step.inputs[0]);
+                if (in.empty()) return false;
+                body_ << "    Elementwise::Relu(" << in << ", " << out << ", " << size << ");\n";
+                return true;
+            }
+            if (kind != OpKind::Add && kind != OpKind::Sub && kind != OpKind::Mul) return false;
+            const auto* binary = dynamic_cast<const BinaryOperation*>(step.node);
+            if (!binary) return false;
+            const std::string lhs = operand(binary->lhsTensor(), binary->lhsTensor() ? 0 : step.inputs[0]);
+            const std::string rhs = operand(binary->rhsTensor(), binary->rhsTensor() ? 0 : step.inputs[binary->lhsTensor() ? 0 : 1]);
+            if (lhs.empty() || rhs.empty()) return false;
+            body_ << "    Elementwise::Binary(ElementwiseOp::" << KindName(kind) << ", " << lhs << ", " << rhs << ", " << out << ", " << size << ");\n";
+            return true;
+        }
+
+        // Operation object of the node's type with its constants, called through compute()
+        void emitOperation(size_t i) {
+            const Executor::Step& step = executor_.schedule()[i];
+            const INode* node = step.node;
+            const std::string name = "op" + std::to_string(i);
+            const auto operand = [&](const Tensor* constant) { return constant ? constantTensor(*constant) : std::string("Placeholder()"); };
+
+            switch (node->kind()) {
+                case OpKind::Add: case OpKind::Sub: case OpKind::Mul: case OpKind::MatMul: case OpKind::Conv: {
+                    const auto* binary = dynamic_cast<const BinaryOperation*>(node);
+                    if (!binary) throw std::invalid_argument("Cannot generate a binary operation of unknown type");
+                    const std::string operands = operand(binary->lhsTensor()) + ", " + operand(binary->rhsTensor());
+                    if (const auto* conv = dynamic_cast<const ConvolOperation*>(node)) {
+                        model_ << "    ConvolOperation " << name << "{" << operands << ", " << conv->getStride() << ", " << conv->getPadding() << "};\n";
+                        if (conv->getAlgorithm() != ConvAlgorithm::Auto)
+                            model_init_ << "        " << name << ".setAlgorithm(static_cast<ConvAlgorithm>(" << static_cast<int>(conv->getAlgorithm()) << "));\n";
+                    } else {
+                        model_ << "    " << ClassName(node->kind()) << " " << name << "{" << operands << "};\n";
+                    }
+                    if (const auto* quantizable = dynamic_cast<const Quantizable*>(node); quantizable && quantizable->getQuantization()) {
+                        const QuantParams& params = *quantizable->getQuantization();
+                        model_init_ << "        " << name << ".setQuantization(QuantParams{" << Float(params.scale) << ", " << params.zero_point << "});\n";
+                    }
+                    break;
+                }
+                case OpKind::ReLU: case OpKind::Softmax: case OpKind::Reorder: {
+                    const auto* unary = dynamic_cast<const UnaryOperation*>(node);
+                    if (!unary) throw std::invalid_argument("Cannot generate a unary operation of unknown type");
+                    model_ << "    " << ClassName(node->kind()) << " " << name << "{" << operand(unary->argTensor());
+                    if (const auto* softmax = dynamic_cast<const SoftmaxOperation*>(node)) model_ << ", " << softmax->getAxis();
+                    if (const auto* reorder = dynamic_cast<const ReorderOperation*>(node)) model_ << ", " << LayoutExpr(reorder->layout());
+                    model_ << "};\n";
+                    break;
+                }
+                default:
+                    throw std::invalid_argument("Cannot generate code for an operation of unknown kind");
+            }
+
+            std::string args;
+            for (size_t k = 0; k < step.nodeInputs(); ++k) args += (k ? ", &" : "&") + tensor(step.inputs[k]);
+            body_ << "    m." << name << ".compute({" << args << "}, s.t" << i;
+            if (!step.addend && !step.addend_is_input && !step.relu) {
+                body_ << ");\n";
+                return;
+            }
+            const std::string addend = step.addend_is_input ? "&" + tensor(step.inputs.back()) : step.addend ? "&" + member(*step.addend) : "nullptr";
+            body_ << ", Epilogue{" << addend << ", " << (step.relu ? "true" : "false") << "});\n";
+        }
+    };
+
+    static void EmitArray(std::ostream& out, const std::string& name, const Tensor& tensor) {
+        const bool f32 = tensor.dtype() == DType::F32;
+        out << "alignas(" << kAlignment << ") const " << (f32 ? "float " : "uint16_t ") << name << "[" << std::max<size_t>(tensor.size(), 1) << "] = {";
+        for (size_t i = 0; i < tensor.size(); ++i) {
+            out << (i % 8 ? " " : "\n    ");
+            if (f32) out << Float(tensor.data()[i]) << ",";
+            else out << "0x" << std::hex << tensor.halfData()[i] << std::dec << ",";
+        }
+        out << "\n};\n\n";
+    }
+
+    // Exact float literal
+    static std::string Float(float value) {
+        if (std::isnan(value)) return "__builtin_nanf(\"\")";
+        if (std::isinf(value)) return value > 0 ? "__builtin_inff()" : "-__builtin_inff()";
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%af", static_cast<double>(value));
+        return buffer;
+    }
+
+    static std::string Shape(const std::vector<size_t>& shape) {
+        std::string out = "{";
+        for (size_t d = 0; d < shape.size(); ++d) out += (d ? ", " : "") + std::to_string(shape[d]);
+        return out + "}";
+    }
+
+    static std::string LayoutExpr(Layout layout) { return std::string("Layout::") + LayoutName(layout); }
+
+    static std::string DTypeExpr(DType dtype) {
+        switch (dtype) {
+            case DType::F32:  return "DType::F32";
+            case DType::BF16: return "DType::BF16";
+            case DType::F16:  return "DType::F16";
+        }
+        return "DType::F32";
+    }
+
+    static std::string Quote(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    static const char* KindName(OpKind kind) {
+        switch (kind) {
+            case OpKind::Input:   return "Input";
+            case OpKind::Add:     return "Add";
+            case OpKind::Sub:     return "Sub";
+            case OpKind::Mul:     return "Mul";
+            case OpKind::MatMul:  return "MatMul";
+            case OpKind::Conv:    return "Conv";
+            case OpKind::ReLU:    return "ReLU";
+            case OpKind::Softmax: return "Softmax";
+            case OpKind::Reorder: return "Reorder";
+            default:              return "Other";
+        }
+    }
+
+    static const char* ClassName(OpKind kind) {
+        switch (kind) {
+            case OpKind::Add:     return "ScalarAddOperation";
+            case OpKind::Sub:     return "ScalarSubOperation";
+            case OpKind::Mul:     return "ScalarMulOperation";
+            case OpKind::MatMul:  return "MatMulOperation";
+            case OpKind::ReLU:    return "ReLUOperation";
+            case OpKind::Softmax: return "SoftmaxOperation";
+            case OpKind::Reorder: return "ReorderOperation";
+            default:              return "";
+        }
+    }
+};
@@ -0,0 +1,49 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#pragma once
+
+// What a cached entry was derived as, part of its key
+enum class ConstantForm {
+    Reordered,       // copy in another layout
+    GemmPanels,      // right GEMM operand in the backend's packed panels
+    WinogradFilters, // filters in the Winograd domain
+    BlockedWeights,  // filters in BlockedConv order
+    Int8Weights      // per-row int8 weights of Int8Gemm
+};
+
+// Forms a node derives from its constant operands (packed GEMM panels,
+// transformed filters, reordered copies), built on first use and shared by every
+// later compute(). The key names the form and everything it depends on, e.g.
+// the GEMM backend and its tile sizes, so switching the backend builds a new
+// entry instead of reusing panels of the wrong shape.
+class ConstantCache {
+public:
+    using Key = std::vector<size_t>;
+
+    // make() returns the form by value; concurrent first calls build it once
+    template <typename T, typename Make>
+    std::shared_ptr<const T> get(const Key& key, Make&& make) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<const void>& entry = entries_[key];
+        if (!entry) entry = std::make_shared<const T>(make());
+        return std::static_pointer_cast<const T>(entry);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    // Forms already handed out stay alive with their holders
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::map<Key, std::shared_ptr<const void>> entries_;
+};
@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <algorithm>
+#include "ConvRow.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 + FMA direct-convolution row kernel for NCHW8c, see BlockedConv.h. Each
+// ymm accumulator holds one output pixel's 8 channels; 12 accumulators, the
+// weight vector and the broadcast input value fit the 16 registers.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class ConvKernelAvx2 {
+public:
+    static constexpr size_t kLanes = 8;
+    static constexpr size_t kPixels = 12;
+    static constexpr size_t kTailPixels = 4;
+
+    __attribute__((target("avx2,fma")))
+    static void Run(const ConvRow &row) {
+        size_t ow = 0;
+        for (; ow + kPixels <= row.out_width; ow += kPixels) Pixels<kPixels>(row, ow, kPixels);
+        for (; ow < row.out_width; ow += kTailPixels) Pixels<kTailPixels>(row, ow, std::min(kTailPixels, row.out_width - ow));
+    }
+
+private:
+    template <size_t P>
+    __attribute__((target("avx2,fma")))
+    static void Pixels(const ConvRow &row, size_t ow0, size_t count) {
+        float *out = row.output + ow0 * kLanes;
+        __m256 acc[P];
+        for (size_t r = 0; r < P; ++r)
+            acc[r] = row.accumulate && r < count ? _mm256_loadu_ps(out + r * kLanes) : _mm256_setzero_ps();
+
+        for (size_t kh = 0; kh < row.kernel_height; ++kh) {
+            const long y = row.InputRow(kh);
+            if (y < 0) continue;
+            for (size_t kw = 0; kw < row.kernel_width; ++kw) {
+                // Interior pixels skip the bounds checks
+                const long x0 = row.InputColumn(ow0, kw);
+                const bool inside = x0 >= 0 && row.InputColumn(ow0 + P - 1, kw) < long(row.width);
+                const float *w = row.weights + ((kh * row.kernel_width + kw) * row.in_channels + row.channel_begin) * kLanes;
+                for (size_t c = row.channel_begin; c < row.channel_end; ++c, w += kLanes) {
+                    const float *line = row.input + ((c / kLanes * row.height + y) * row.width) * kLanes + c % kLanes;
+                    const __m256 W = _mm256_loadu_ps(w);
+                    if (inside) {
+                        const float *px = line + x0 * long(kLanes);
+                        for (size_t r = 0; r < P; ++r)
+                            acc[r] = _mm256_fmadd_ps(_mm256_set1_ps(px[r * row.stride * kLanes]), W, acc[r]);
+                    } else {
+                        for (size_t r = 0; r < P; ++r) {
+                            const long x = x0 + long(r * row.stride);
+                            if (x >= 0 && x < long(row.width))
+                                acc[r] = _mm256_fmadd_ps(_mm256_set1_ps(line[x * long(kLanes)]), W, acc[r]);
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t r = 0; r < count; ++r) {
+            if (row.epilogue && row.epilogue->addend)
+                acc[r] = _mm256_add_ps(acc[r], _mm256_loadu_ps(row.epilogue->addend + (ow0 + r) * row.epilogue->ld_addend));
+            if (row.epilogue && row.epilogue->relu) acc[r] = _mm256_max_ps(acc[r], _mm256_setzero_ps());
+            _mm256_storeu_ps(out + r * kLanes, acc[r]);
+        }
+    }
+};
+
+#endif
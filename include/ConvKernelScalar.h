@@ -0,0 +1,47 @@
+#include <cstddef>
+#include <algorithm>
+#include "ConvRow.h"
+
+#pragma once
+
+// Portable direct-convolution row kernel, see BlockedConv.h. Lanes is the
+// channel block of the layout; the compiler vectorizes the lane loops.
+template <size_t Lanes>
+class ConvKernelScalar {
+public:
+    static constexpr size_t kLanes = Lanes;
+    static constexpr size_t kPixels = 4;
+
+    static void Run(const ConvRow &row) {
+        for (size_t ow = 0; ow < row.out_width; ow += kPixels) Pixels(row, ow, std::min(kPixels, row.out_width - ow));
+    }
+
+private:
+    static void Pixels(const ConvRow &row, size_t ow0, size_t count) {
+        float *out = row.output + ow0 * kLanes;
+        float acc[kPixels][kLanes];
+        for (size_t r = 0; r < kPixels; ++r)
+            for (size_t l = 0; l < kLanes; ++l) acc[r][l] = row.accumulate && r < count ? out[r * kLanes + l] : 0.0f;
+
+        for (size_t kh = 0; kh < row.kernel_height; ++kh) {
+            const long y = row.InputRow(kh);
+            if (y < 0) continue;
+            for (size_t kw = 0; kw < row.kernel_width; ++kw) {
+                const float *w = row.weights + ((kh * row.kernel_width + kw) * row.in_channels + row.channel_begin) * kLanes;
+                for (size_t c = row.channel_begin; c < row.channel_end; ++c, w += kLanes) {
+                    const float *line = row.input + ((c / kLanes * row.height + y) * row.width) * kLanes + c % kLanes;
+                    for (size_t r = 0; r < count; ++r) {
+                        const long x = row.InputColumn(ow0 + r, kw);
+                        if (x < 0 || x >= long(row.width)) continue;
+                        const float value = line[x * kLanes];
+                        for (size_t l = 0; l < kLanes; ++l) acc[r][l] += value * w[l];
+                    }
+                }
+            }
+        }
+
+        for (size_t r = 0; r < count; ++r)
+            for (size_t l = 0; l < kLanes; ++l)
+                out[r * kLanes + l] = row.epilogue ? row.epilogue->Apply(acc[r][l], l, ow0 + r) : acc[r][l];
+    }
+};
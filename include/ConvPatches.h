@@ -0,0 +1,56 @@
+#include <cstddef>
+#include <algorithm>
+
+#pragma once
+
+// The im2col matrix of one NCHW image, never materialized: row i is output
+// position (i / out_width, i % out_width), column p is (channel, kh, kw) in OIHW
+// weight order. Patches are gathered while BlockedGemm packs A, so a convolution
+// needs only the GEMM packing buffers instead of depth x out_size floats.
+struct ConvPatches {
+    const float *image;
+    size_t height, width;
+    size_t kernel_height, kernel_width;
+    size_t stride, padding;
+    size_t out_width;
+
+    // Same contract as StridedMatrix::Pack
+    template <size_t MR>
+    void Pack(size_t i0, size_t mc, size_t p0, size_t kc, float *buffer) const {
+        const size_t kernel_size = kernel_height * kernel_width;
+        for (size_t ir = 0; ir < mc; ir += MR) {
+            const size_t mr = std::min(MR, mc - ir);
+
+            // Top-left input corner of every patch in this micro-panel
+            long row0[MR], col0[MR];
+            for (size_t i = 0; i < mr; ++i) {
+                const size_t pos = i0 + ir + i;
+                row0[i] = long(pos / out_width * stride) - long(padding);
+                col0[i] = long(pos % out_width * stride) - long(padding);
+            }
+
+            size_t c = p0 / kernel_size;
+            size_t kh = p0 % kernel_size / kernel_width;
+            size_t kw = p0 % kernel_width;
+            for (size_t p = 0; p < kc; ++p) {
+                const float *plane = image + c * height * width;
+                for (size_t i = 0; i < mr; ++i) {
+                    const long y = row0[i] + long(kh);
+                    const long x = col0[i] + long(kw);
+                    const bool inside = y >= 0 && x >= 0 && y < long(height) && x < long(width);
+                    buffer[i] = inside ? plane[y * long(width) + x] : 0.0f;
+                }
+                for (size_t i = mr; i < MR; ++i) buffer[i] = 0.0f;
+                buffer += MR;
+
+                if (++kw == kernel_width) {
+                    kw = 0;
+                    if (++kh == kernel_height) {
+                        kh = 0;
+                        ++c;
+                    }
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,32 @@
+#include <cstddef>
+#include "GemmEpilogue.h"
+
+#pragma once
+
+// One output row of a direct convolution over channel-blocked (NCHW8c / NCHW16c)
+// tensors, for one block of output channels and a range of input channels.
+// Computed by the ConvKernel* classes, see BlockedConv.h.
+struct ConvRow {
+    const float *input;          // one image, all channel blocks
+    size_t height, width;
+    size_t in_channels;          // of the image, also the weights' channel stride
+    size_t channel_begin;        // input channels summed by this call
+    size_t channel_end;
+    const float *weights;        // this output block's [kh][kw][in_channels][lanes]
+    size_t kernel_height, kernel_width;
+    size_t stride, padding;
+    size_t out_row;
+    size_t out_width;
+    float *output;               // first pixel of the row, [out_width][lanes]
+    bool accumulate;             // add to the row instead of overwriting it
+    const GemmEpilogue *epilogue; // for the final channel range only; element (lane, pixel)
+
+    // Input row of tap kh, or -1 outside the image
+    long InputRow(size_t kh) const {
+        const long y = long(out_row * stride + kh) - long(padding);
+        return y >= 0 && y < long(height) ? y : -1;
+    }
+
+    // Input column of pixel ow under tap kw, may be outside the image
+    long InputColumn(size_t ow, size_t kw) const { return long(ow * stride + kw) - long(padding); }
+};
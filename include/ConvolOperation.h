@@ -1,30 +1,140 @@
 #include "Operations.h"
 #include "FastMatMul.h"
 #include "Im2Col.h"
+#include "Winograd.h"
+#include "ConvPatches.h"
+#include "BlockedConv.h"
+#include "Int8Gemm.h"
 #include <iterator>
 
 #pragma once
 
 
-class ConvolOperation : public BinaryOperation {
+// How ConvolOperation computes NCHW results. Auto picks F(4x4, 3x3) Winograd for 3x3,
+// stride-1 layers large enough to amortize the transforms, implicit GEMM otherwise.
+// Channel-blocked tensors always use the direct kernels of BlockedConv.
+enum class ConvAlgorithm {
+    Auto,
+    Im2Col,       // unfolded patch matrix + GEMM
+    ImplicitGemm, // GEMM gathering patches while packing, no unfolded matrix
+    Winograd2x2, // F(2x2, 3x3)
+    Winograd4x4  // F(4x4, 3x3)
+};
+
+
+class ConvolOperation : public BinaryOperation, public Quantizable {
 public:
     ConvolOperation(const std::shared_ptr<INode> lhs, const std::shared_ptr<INode> rhs, size_t stride, size_t padding): 
         BinaryOperation(lhs, rhs), stride_(stride), padding_(padding) {}
-    ConvolOperation(const std::shared_ptr<INode> lhs, const Tensor& rhs_tensor, size_t stride, size_t padding): 
-        BinaryOperation(lhs, rhs_tensor), stride_(stride), padding_(padding) {}
-    ConvolOperation(const Tensor& lhs_tensor, const std::shared_ptr<INode> rhs, size_t stride, size_t padding): 
-        BinaryOperation(lhs_tensor, rhs), stride_(stride), padding_(padding) {}
-    ConvolOperation(const Tensor& lhs_tensor, const Tensor& rhs_tensor, size_t stride, size_t padding): 
-        BinaryOperation(lhs_tensor, rhs_tensor), stride_(stride), padding_(padding) {}
-
-    Tensor evaluate() const override {
-        Tensor lhs_tensor;
-        Tensor rhs_tensor;
-        
-        if(lhs_is_node_) lhs_tensor = lhs_->evaluate();
-        else lhs_tensor = lhs_tensor_;
-        if(rhs_is_node_) rhs_tensor = rhs_->evaluate();
-        else rhs_tensor = rhs_tensor_;
+    ConvolOperation(const std::shared_ptr<INode> lhs, Tensor rhs_tensor, size_t stride, size_t padding): 
+        BinaryOperation(lhs, std::move(rhs_tensor)), stride_(stride), padding_(padding) {}
+    ConvolOperation(Tensor lhs_tensor, const std::shared_ptr<INode> rhs, size_t stride, size_t padding): 
+        BinaryOperation(std::move(lhs_tensor), rhs), stride_(stride), padding_(padding) {}
+    ConvolOperation(Tensor lhs_tensor, Tensor rhs_tensor, size_t stride, size_t padding): 
+        BinaryOperation(std::move(lhs_tensor), std::move(rhs_tensor)), stride_(stride), padding_(padding) {}
+
+    using BinaryOperation::compute;
+
+    std::vector<size_t> outputShape(const std::vector<size_t>& lhs_shape, const std::vector<size_t>& rhs_shape) const override {
+        if (lhs_shape[1] != rhs_shape[1]) {
+            throw std::invalid_argument("Input channels must match kernel input channels");
+        }
+        const size_t out_height = (lhs_shape[2] + 2 * padding_ - rhs_shape[2]) / stride_ + 1;
+        const size_t out_width = (lhs_shape[3] + 2 * padding_ - rhs_shape[3]) / stride_ + 1;
+        return {lhs_shape[0], rhs_shape[0], out_height, out_width};
+    }
+
+    OpKind kind() const override { return OpKind::Conv; }
+
+    size_t getStride() const { return stride_; }
+    size_t getPadding() const { return padding_; }
+
+    // Forces an algorithm; Winograd ones throw on shapes they cannot handle
+    void setAlgorithm(ConvAlgorithm algorithm) { algorithm_ = algorithm; }
+
+    ConvAlgorithm getAlgorithm() const { return algorithm_; }
+
+    // Algorithm compute() uses for these shapes, Auto resolved
+    ConvAlgorithm chooseAlgorithm(const std::vector<size_t>& lhs_shape, const std::vector<size_t>& rhs_shape) const {
+        const bool winograd_shape = rhs_shape[2] == 3 && rhs_shape[3] == 3 && stride_ == 1 &&
+                                    lhs_shape[2] + 2 * padding_ >= 3 && lhs_shape[3] + 2 * padding_ >= 3;
+        if (algorithm_ != ConvAlgorithm::Auto) {
+            const bool winograd = algorithm_ == ConvAlgorithm::Winograd2x2 || algorithm_ == ConvAlgorithm::Winograd4x4;
+            if (winograd && !winograd_shape)
+                throw std::invalid_argument("Winograd convolution needs a 3x3 kernel with stride 1");
+            return algorithm_;
+        }
+        // Few channels leave the transforms dominating the GEMM, and small outputs
+        // waste most of a 4x4 tile. F(2x2) only saves 2.25x multiplications, which
+        // its transforms eat up, so Auto never picks it.
+        if (!winograd_shape || lhs_shape[1] < 8 || rhs_shape[0] < 8) return ConvAlgorithm::ImplicitGemm;
+        const std::vector<size_t> out_shape = outputShape(lhs_shape, rhs_shape);
+        return out_shape[2] >= 6 && out_shape[3] >= 6 ? ConvAlgorithm::Winograd4x4 : ConvAlgorithm::ImplicitGemm;
+    }
+
+    bool fusesEpilogue() const override { return true; }
+
+    bool fusesBias() const override { return true; }
+
+    // bf16/f16 weights stay 16-bit in their packed GEMM panels; transformed
+    // filters (Winograd, blocked, int8) are built from a widened copy
+    bool readsHalf() const override { return true; }
+
+    bool supportsLayout(Layout layout) const override { return layout == Layout::NCHW || IsBlocked(layout); }
+
+    // Weights stay OIHW whatever the activation layout
+    Layout inputLayout(size_t input, Layout layout) const override {
+        return lhs_is_node_ && input == 0 ? layout : Layout::NCHW;
+    }
+
+    // The direct blocked kernels beat the GEMM paths on shallow layers with wide
+    // rows, and lose on deep, narrow ones where the GEMM blocks for cache better.
+    // Past 32 channels F(4x4) Winograd is as fast, so it keeps NCHW.
+    // The int8 path is NCHW only.
+    Layout preferredLayout(const std::vector<Layout>&, const std::vector<std::vector<size_t>>& arg_shapes, Layout blocked) const override {
+        if (quantization_ || algorithm_ != ConvAlgorithm::Auto || !IsBlocked(blocked)) return Layout::NCHW;
+        const std::vector<size_t>& lhs = lhs_is_node_ ? arg_shapes[0] : lhs_tensor_.shape();
+        const std::vector<size_t>& rhs = rhs_is_node_ ? arg_shapes[lhs_is_node_ ? 1 : 0] : rhs_tensor_.shape();
+        if (lhs[1] > 64 || outputShape(lhs, rhs)[3] < 16) return Layout::NCHW;
+        if (lhs[1] > 32 && chooseAlgorithm(lhs, rhs) == ConvAlgorithm::Winograd4x4) return Layout::NCHW;
+        return blocked;
+    }
+
+    void compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& out_tensor) const override {
+        compute(lhs_tensor, rhs_tensor, out_tensor, Epilogue());
+    }
+
+    // Bias add and ReLU run inside the GEMM store, see GemmEpilogue; a [1, C, 1, 1]
+    // addend is read as one value per output channel
+    void compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& out_tensor, const Epilogue& epilogue) const override {
+        outputShape(lhs_tensor.shape(), rhs_tensor.shape());
+        const bool per_channel = epilogue.addend && epilogue.addend->shape() != out_tensor.shape();
+        if (per_channel && !Epilogue::IsChannelBias(epilogue.addend->shape(), out_tensor.shape()))
+            throw std::invalid_argument("Shapes must match for addition.");
+        checkLayout(lhs_tensor);
+        if (out_tensor.layout() != lhs_tensor.layout()) throw std::invalid_argument("Convolution output must be stored like its input");
+        if (out_tensor.dtype() != DType::F32) throw std::invalid_argument("Convolution results are f32");
+
+        // 16-bit activations and addends are widened up front
+        if (lhs_tensor.dtype() != DType::F32 || (epilogue.addend && epilogue.addend->dtype() != DType::F32)) {
+            Tensor addend;
+            Epilogue widened = epilogue;
+            if (epilogue.addend) {
+                addend = epilogue.addend->toDType(DType::F32);
+                widened.addend = &addend;
+            }
+            compute(lhs_tensor.toDType(DType::F32), rhs_tensor, out_tensor, widened);
+            return;
+        }
+        // Weights keep their own layout here: the forms built from them are
+        // cached on rhs_tensor, and reordered to OIHW only while building
+        const Tensor& weights = rhs_tensor;
+        Tensor addend_scratch;
+        const Tensor* addend_tensor = epilogue.addend ? &inLayout(*epilogue.addend, out_tensor.layout(), addend_scratch) : nullptr;
+        if (IsBlocked(lhs_tensor.layout())) {
+            computeBlocked(lhs_tensor, weights, out_tensor, addend_tensor ? addend_tensor->data() : nullptr, epilogue.relu, per_channel);
+            return;
+        }
 
         // Extract dimensions
         const size_t batch_size = lhs_tensor.shape(0);
@@ -32,98 +142,199 @@ public:
         const size_t in_height = lhs_tensor.shape(2);
         const size_t in_width = lhs_tensor.shape(3);
         
-        const size_t kernel_out_channels = rhs_tensor.shape(0);
-        const size_t kernel_in_channels = rhs_tensor.shape(1);
-        const size_t kernel_height = rhs_tensor.shape(2);
-        const size_t kernel_width = rhs_tensor.shape(3);
-        
-        if (in_channels != kernel_in_channels) {
-            throw std::invalid_argument("Input channels must match kernel input channels");
-        }
+        const size_t kernel_out_channels = weights.shape(0);
+        const size_t kernel_height = weights.shape(2);
+        const size_t kernel_width = weights.shape(3);
         
         const size_t stride = stride_;
         const size_t padding = padding_;
-        
+
+        const float* addend = addend_tensor ? addend_tensor->data() : nullptr;
+        if (quantization_) {
+            computeInt8(lhs_tensor, weights, out_tensor, addend, epilogue.relu, per_channel);
+            return;
+        }
+
+        const ConvAlgorithm algorithm = chooseAlgorithm(lhs_tensor.shape(), weights.shape());
+        switch (algorithm) {
+            case ConvAlgorithm::Winograd2x2:
+                WinogradConv<2>::Run(lhs_tensor.data(), batch_size, in_channels, in_height, in_width, padding,
+                                     winogradFilters<2>(weights)->data(), kernel_out_channels,
+                                     out_tensor.data(), addend, epilogue.relu, per_channel);
+                return;
+            case ConvAlgorithm::Winograd4x4:
+                WinogradConv<4>::Run(lhs_tensor.data(), batch_size, in_channels, in_height, in_width, padding,
+                                     winogradFilters<4>(weights)->data(), kernel_out_channels,
+                                     out_tensor.data(), addend, epilogue.relu, per_channel);
+                return;
+            default:
+                break;
+        }
+
+        // Weights as the packed GEMM operand B(depth x out_channels) = W^T
+        const std::shared_ptr<const FastMatMul::PackedMatrix> packed_weights = packedWeights(weights);
         const size_t out_height = (in_height + 2 * padding - kernel_height) / stride + 1;
         const size_t out_width = (in_width + 2 * padding - kernel_width) / stride + 1;
-        
-        Tensor out_tensor(batch_size, kernel_out_channels, out_height, out_width);
-        
+        const size_t out_size = out_height * out_width;
+        const size_t image_size = in_channels * in_height * in_width;
+
+        // C^T[pos, oc] = patches[pos, d] * W^T[d, oc]: column-major C^T of every image is
+        // its NCHW output slice, so the epilogue addend shares the output's strides,
+        // and a channel bias is one value per column
+        GemmEpilogue gemm_epilogue;
+        gemm_epilogue.addend = addend;
+        gemm_epilogue.ld_addend = per_channel ? 1 : out_size;
+        gemm_epilogue.rs_addend = per_channel ? 0 : 1;
+        gemm_epilogue.relu = epilogue.relu;
+        const GemmEpilogue* fused = epilogue.empty() ? nullptr : &gemm_epilogue;
+
+        if (algorithm == ConvAlgorithm::ImplicitGemm) {
+            // The whole batch in one GEMM: patches are gathered image by image while packing
+            const auto patches = [&](size_t batch) {
+                return ConvPatches{
+                    lhs_tensor.data() + batch * image_size, in_height, in_width,
+                    kernel_height, kernel_width, stride, padding, out_width
+                };
+            };
+            FastMatMul::GemmPacked(batch_size, out_size, patches, *packed_weights,
+                                   out_tensor.data(), out_size, kernel_out_channels * out_size, fused);
+            return;
+        }
+
         for (size_t batch = 0; batch < batch_size; ++batch) {
             performConvolutionIm2Col(
-                lhs_tensor, rhs_tensor, out_tensor, batch, 
+                lhs_tensor, *packed_weights, out_tensor, batch,
                 in_channels, in_height, in_width,
                 kernel_out_channels, kernel_height, kernel_width,
-                stride, padding
+                stride, padding, fused
             );
         }
-        
-        return out_tensor;
     }
     
 private:
     size_t stride_;
     size_t padding_;
+    ConvAlgorithm algorithm_ = ConvAlgorithm::Auto;
+
+    void computeBlocked(const Tensor& input, const Tensor& weights, Tensor& output, const float* addend, bool relu, bool per_channel) const {
+        const GemmBackend backend = FastMatMul::GetBackend();
+        const bool simd = backend != GemmBackend::Scalar;
+        if (ChannelBlock(input.layout()) == 16) {
+#if defined(__x86_64__) || defined(__i386__)
+            if (simd && FastMatMul::IsBackendAvailable(GemmBackend::Avx512)) return runBlocked<ConvKernelAvx512>(input, weights, output, addend, relu, per_channel);
+#endif
+            return runBlocked<ConvKernelScalar<16>>(input, weights, output, addend, relu, per_channel);
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        if (simd && FastMatMul::IsBackendAvailable(GemmBackend::Avx2)) return runBlocked<ConvKernelAvx2>(input, weights, output, addend, relu, per_channel);
+#endif
+        runBlocked<ConvKernelScalar<8>>(input, weights, output, addend, relu, per_channel);
+    }
+
+    template <typename Kernel>
+    void runBlocked(const Tensor& input, const Tensor& weights, Tensor& output, const float* addend, bool relu, bool per_channel) const {
+        BlockedConv<Kernel>::Run(input.data(), input.shape(0), input.shape(1), input.shape(2), input.shape(3),
+                                 blockedWeights<Kernel>(weights)->data(), weights.shape(0), weights.shape(2), weights.shape(3),
+                                 stride_, padding_, output.data(), addend, relu, per_channel);
+    }
+
+    // im2col per image feeding Int8Gemm with C = W(out_channels x depth) * patches,
+    // which is the image's NCHW output. 1x1 stride-1 layers read the image in place.
+    void computeInt8(const Tensor& input, const Tensor& weights, Tensor& output, const float* addend, bool relu, bool per_channel) const {
+        const size_t batch_size = input.shape(0), in_channels = input.shape(1);
+        const size_t in_height = input.shape(2), in_width = input.shape(3);
+        const size_t out_channels = weights.shape(0), kernel_height = weights.shape(2), kernel_width = weights.shape(3);
+        const size_t out_height = output.shape(2), out_width = output.shape(3);
+        const size_t out_size = out_height * out_width;
+        const size_t depth = in_channels * kernel_height * kernel_width;
+        const size_t image_size = in_channels * in_height * in_width;
+        const bool pointwise = kernel_height == 1 && kernel_width == 1 && stride_ == 1 && padding_ == 0;
+
+        const std::shared_ptr<const Int8Gemm::Weights> int8_weights = constantForm<Int8Gemm::Weights>(
+            weights, ConstantForm::Int8Weights, {}, [&] {
+                Tensor scratch;
+                return Int8Gemm::QuantizeWeights(out_channels, depth, oihwFloat(weights, scratch).data(), depth, 1);
+            });
+        std::vector<float> patches(pointwise ? 0 : depth * out_size);
+        for (size_t batch = 0; batch < batch_size; ++batch) {
+            const float* image = input.data() + batch * image_size;
+            if (!pointwise) {
+                Im2Col(image, in_channels, in_height, in_width, kernel_height, kernel_width,
+                       padding_, padding_, stride_, stride_, patches.data());
+            }
+            const size_t offset = batch * out_channels * out_size;
+            Int8Gemm::Run(*int8_weights, pointwise ? image : patches.data(), out_size, out_size, *quantization_,
+                          output.data() + offset, out_size, addend && !per_channel ? addend + offset : addend,
+                          per_channel ? 1 : out_size, relu, per_channel);
+        }
+    }
+
+    // Weights in BlockedConv order
+    template <typename Kernel>
+    std::shared_ptr<const std::vector<float>> blockedWeights(const Tensor& weights) const {
+        return constantForm<std::vector<float>>(weights, ConstantForm::BlockedWeights, {Kernel::kLanes}, [&] {
+            Tensor scratch;
+            return BlockedConv<Kernel>::TransformWeights(
+                oihwFloat(weights, scratch).data(), weights.shape(0), weights.shape(1), weights.shape(2), weights.shape(3));
+        });
+    }
+
+    // Winograd-domain filters
+    template <size_t M>
+    std::shared_ptr<const std::vector<float>> winogradFilters(const Tensor& weights) const {
+        return constantForm<std::vector<float>>(weights, ConstantForm::WinogradFilters, {M}, [&] {
+            Tensor scratch;
+            return WinogradConv<M>::TransformFilters(oihwFloat(weights, scratch).data(), weights.shape(0), weights.shape(1));
+        });
+    }
 
     void performConvolutionIm2Col(
-        const Tensor& input, const Tensor& weights, Tensor& output,
+        const Tensor& input, const FastMatMul::PackedMatrix& weights, Tensor& output,
         size_t batch,
         size_t in_channels, size_t in_height, size_t in_width,
         size_t out_channels, size_t kernel_height, size_t kernel_width,
-        size_t stride, size_t padding
+        size_t stride, size_t padding,
+        const GemmEpilogue* epilogue
     ) const {
         // Calculate output dimensions
         const size_t out_height = (in_height + 2 * padding - kernel_height) / stride + 1;
         const size_t out_width = (in_width + 2 * padding - kernel_width) / stride + 1;
-        
-        // Create im2col matrix
-        std::vector<float> im2col_data(kernel_height * kernel_width * in_channels * out_height * out_width, 0.0f);
-        
-        // Extract input data for the current batch
-        std::vector<float> input_data(in_channels * in_height * in_width);
-        for (size_t c = 0; c < in_channels; ++c) {
-            for (size_t h = 0; h < in_height; ++h) {
-                for (size_t w = 0; w < in_width; ++w) {
-                    input_data[c * in_height * in_width + h * in_width + w] = input.at(batch, c, h, w);
-                }
-            }
-        }
-        
-        // Apply im2col transform
+
+        // Create im2col matrix: [depth, out_height * out_width], row-major
+        const size_t out_size = out_height * out_width;
+        const size_t depth = kernel_height * kernel_width * in_channels;
+        std::vector<float> im2col_data(depth * out_size, 0.0f);
+
+        // This batch's image is a contiguous slice of the input, read in place
+        const ConstTensorView image = ConstTensorView(input).slice(0, batch, batch + 1);
         Im2Col(
-            input_data.data(), in_channels, in_height, in_width,
+            image.data(), in_channels, in_height, in_width,
             kernel_height, kernel_width, padding, padding, stride, stride,
             im2col_data.data()
         );
-        
-        // Reshape weights to match im2col for matrix multiplication
-        std::vector<float> weight_matrix(out_channels * kernel_height * kernel_width * in_channels);
-        for (size_t oc = 0; oc < out_channels; ++oc) {
-            for (size_t ic = 0; ic < in_channels; ++ic) {
-                for (size_t kh = 0; kh < kernel_height; ++kh) {
-                    for (size_t kw = 0; kw < kernel_width; ++kw) {
-                        const size_t weight_idx = oc * (in_channels * kernel_height * kernel_width) + 
-                                                 ic * (kernel_height * kernel_width) + 
-                                                 kh * kernel_width + kw;
-                        weight_matrix[weight_idx] = weights.at(oc, ic, kh, kw);
-                    }
-                }
-            }
-        }
-        
-        std::vector<float> output_data = MatrixMultiplyNeon::MatrixMultiplyFast(
-            weight_matrix, im2col_data,
-            out_channels, out_height * out_width, kernel_height * kernel_width * in_channels
-        );
-        
-        // Reshape output to NCHW format
-        for (size_t oc = 0; oc < out_channels; ++oc) {
-            for (size_t oh = 0; oh < out_height; ++oh) {
-                for (size_t ow = 0; ow < out_width; ++ow) {
-                    const size_t out_idx = oc * out_height * out_width + oh * out_width + ow;
-                    output.at(batch, oc, oh, ow) = output_data[out_idx];
-                }
-            }
-        }
+
+        // Patch matrix [out_size, depth] is the transposed im2col buffer
+        const size_t batch_offset = batch * out_channels * out_size;
+        GemmEpilogue batch_epilogue;
+        if (epilogue) batch_epilogue = epilogue->Offset(batch_offset, 0);
+        FastMatMul::GemmPacked(1, out_size, [&](size_t) { return StridedMatrix{im2col_data.data(), 1, out_size}; },
+                               weights, output.data() + batch_offset, out_size, 0,
+                               epilogue ? &batch_epilogue : nullptr);
+    }
+
+    // Weights packed for the active GEMM backend, once for the whole batch, in
+    // the weights' own dtype
+    std::shared_ptr<const FastMatMul::PackedMatrix> packedWeights(const Tensor& weights) const {
+        const size_t out_channels = weights.shape(0);
+        const size_t depth = weights.shape(1) * weights.shape(2) * weights.shape(3);
+        return constantForm<FastMatMul::PackedMatrix>(weights, ConstantForm::GemmPanels, FastMatMul::TileConfig(), [&] {
+            Tensor scratch;
+            return FastMatMul::PrepackBatched(1, depth, out_channels, oihwFloat(weights, scratch).data(), 1, depth, 0, weights.dtype());
+        });
+    }
+
+    // Weights as f32 OIHW, whatever their dtype and layout, for building the forms above
+    static const Tensor& oihwFloat(const Tensor& weights, Tensor& scratch) {
+        return INode::inLayout(inFloat(weights, scratch), Layout::NCHW, scratch);
     }
 };
\ No newline at end of file
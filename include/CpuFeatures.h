@@ -0,0 +1,71 @@
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#pragma once
+
+// Instruction set extensions available on the running host.
+// Queried once from CPUID (x86) or fixed at compile time (ARM).
+struct CpuFeatures {
+    bool neon = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vnni = false; // int8 dot products on zmm
+    bool avxvnni = false;    // the same on ymm, VEX encoded
+    bool avx512bf16 = false;
+
+    static const CpuFeatures& Get() {
+        static const CpuFeatures features = Detect();
+        return features;
+    }
+
+private:
+    static CpuFeatures Detect() {
+        CpuFeatures f;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        f.neon = true;
+#elif defined(__x86_64__) || defined(__i386__)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return f;
+
+        const bool osxsave = ecx & bit_OSXSAVE;
+        const bool avx = ecx & bit_AVX;
+        const bool fma = ecx & bit_FMA;
+        const bool f16c = ecx & bit_F16C;
+        if (!osxsave || !avx) return f;
+
+        // The OS has to save YMM (and ZMM/opmask) state on context switch
+        const uint64_t xcr0 = ReadXcr0();
+        const bool ymm_enabled = (xcr0 & 0x6) == 0x6;
+        const bool zmm_enabled = (xcr0 & 0xe6) == 0xe6;
+        if (!ymm_enabled) return f;
+
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return f;
+        f.avx2 = ebx & bit_AVX2;
+        f.fma = fma;
+        f.f16c = f16c;
+        f.avx512f = zmm_enabled && (ebx & bit_AVX512F);
+        f.avx512bw = f.avx512f && (ebx & bit_AVX512BW);
+        f.avx512vnni = f.avx512bw && (ecx & bit_AVX512VNNI);
+
+        if (__get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+            f.avxvnni = f.avx2 && (eax & bit_AVXVNNI);
+            f.avx512bf16 = f.avx512f && (eax & bit_AVX512BF16);
+        }
+#endif
+        return f;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    static uint64_t ReadXcr0() {
+        uint32_t lo = 0, hi = 0;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+    }
+#endif
+};
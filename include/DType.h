@@ -0,0 +1,79 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#pragma once
+
+// Element type a Tensor stores. Kernels compute in float whatever the
+// storage: 16-bit operands are widened while they are packed.
+enum class DType {
+    F32,
+    BF16, // float's upper 16 bits: same range, 8-bit mantissa
+    F16   // IEEE half: 5-bit exponent, 11-bit mantissa, max 65504
+};
+
+inline size_t DTypeSize(DType dtype) { return dtype == DType::F32 ? 4 : 2; }
+
+inline const char* DTypeName(DType dtype) {
+    switch (dtype) {
+        case DType::F32:  return "f32";
+        case DType::BF16: return "bf16";
+        case DType::F16:  return "f16";
+    }
+    return "?";
+}
+
+// Software conversions, round to nearest even, NaN kept quiet; the fallback
+// of HalfConvert and its reference in tests
+namespace half {
+
+inline uint32_t Bits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float FromBits(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint16_t FloatToBf16(float value) {
+    const uint32_t bits = Bits(value);
+    if ((bits & 0x7fffffffu) > 0x7f800000u) return static_cast<uint16_t>((bits >> 16) | 0x40);
+    return static_cast<uint16_t>((bits + 0x7fffu + ((bits >> 16) & 1)) >> 16);
+}
+
+inline float Bf16ToFloat(uint16_t value) { return FromBits(static_cast<uint32_t>(value) << 16); }
+
+// Float arithmetic does the rounding: scaling up then down pushes values past
+// half's range to infinity, and adding a power of two aligned to the result's
+// exponent leaves exactly its 10 mantissa bits in the float's low bits
+inline uint16_t FloatToF16(float value) {
+    const uint32_t bits = Bits(value);
+    const uint32_t shl1 = bits + bits;
+    const uint32_t sign = bits & 0x80000000u;
+    float base = ((value < 0.0f ? -value : value) * 0x1.0p+112f) * 0x1.0p-110f;
+    uint32_t bias = shl1 & 0xff000000u;
+    if (bias < 0x71000000u) bias = 0x71000000u;
+    base = FromBits((bias >> 1) + 0x07800000u) + base;
+    const uint32_t rounded = Bits(base);
+    const uint32_t nonsign = ((rounded >> 13) & 0x7c00u) + (rounded & 0x0fffu);
+    return static_cast<uint16_t>((sign >> 16) | (shl1 > 0xff000000u ? 0x7e00u : nonsign));
+}
+
+inline float F16ToFloat(uint16_t value) {
+    const uint32_t bits = static_cast<uint32_t>(value) << 16;
+    const uint32_t sign = bits & 0x80000000u;
+    const uint32_t shl1 = bits + bits;
+    const float normalized = FromBits((shl1 >> 4) + (0xe0u << 23)) * 0x1.0p-112f;
+    const float denormalized = FromBits((shl1 >> 17) | (126u << 23)) - 0.5f;
+    return FromBits(sign | (shl1 < (1u << 27) ? Bits(denormalized) : Bits(normalized)));
+}
+
+inline float ToFloat(DType dtype, uint16_t value) {
+    return dtype == DType::BF16 ? Bf16ToFloat(value) : F16ToFloat(value);
+}
+
+} // namespace half
@@ -0,0 +1,133 @@
+#include <cstddef>
+#include <vector>
+#include "CpuFeatures.h"
+#include "ElementwiseOp.h"
+#include "ElementwiseKernelScalar.h"
+#include "ElementwiseKernelNeon.h"
+#include "ElementwiseKernelAvx2.h"
+#include "ElementwiseKernelAvx512.h"
+
+#pragma once
+
+// Elementwise kernels over raw storage, for the widest ISA of this CPU (picked
+// from CPUID on first use, like the GEMM backend). out may be the same buffer
+// as any operand, which is how executors run elementwise steps in place.
+class Elementwise {
+public:
+    // out = a op b over n elements, then max(0, out) when relu is set
+    static void Binary(ElementwiseOp op, const float *a, const float *b, float *out, size_t n, bool relu = false) {
+        if (n > 0) Kernel(op, false, false)(a, b, out, n, relu);
+    }
+
+    // out = a op b over a box of dims (outermost first) stored contiguously in out.
+    // a_strides and b_strides hold each operand's element stride per dimension,
+    // 0 where it is broadcast (see BroadcastStrides). Dimensions contiguous for
+    // both operands are merged, so the kernels run over the longest possible
+    // rows, each operand either streamed or held in a register.
+    static void Binary(ElementwiseOp op,
+                       const float *a, const std::vector<size_t> &a_strides,
+                       const float *b, const std::vector<size_t> &b_strides,
+                       float *out, const std::vector<size_t> &dims, bool relu = false) {
+        // Merged dimensions, innermost first
+        std::vector<size_t> extent, sa, sb;
+        for (size_t d = dims.size(); d-- > 0;) {
+            if (dims[d] == 0) return;
+            if (dims[d] == 1) continue;
+            if (!extent.empty() && a_strides[d] == sa.back() * extent.back() && b_strides[d] == sb.back() * extent.back()) {
+                extent.back() *= dims[d];
+            } else {
+                extent.push_back(dims[d]);
+                sa.push_back(a_strides[d]);
+                sb.push_back(b_strides[d]);
+            }
+        }
+        // Kernels take unit or zero strides; anything else runs element by element
+        if (extent.empty() || sa[0] > 1 || sb[0] > 1) {
+            extent.insert(extent.begin(), 1);
+            sa.insert(sa.begin(), 0);
+            sb.insert(sb.begin(), 0);
+        }
+
+        const auto kernel = Kernel(op, sa[0] == 0, sb[0] == 0);
+        const size_t n = extent[0];
+        size_t runs = 1;
+        for (size_t d = 1; d < extent.size(); ++d) runs *= extent[d];
+
+        std::vector<size_t> index(extent.size(), 0);
+        size_t offset_a = 0, offset_b = 0;
+        for (size_t run = 0; run < runs; ++run) {
+            kernel(a + offset_a, b + offset_b, out + run * n, n, relu);
+            for (size_t d = 1; d < extent.size(); ++d) {
+                offset_a += sa[d];
+                offset_b += sb[d];
+                if (++index[d] < extent[d]) break;
+                offset_a -= sa[d] * extent[d];
+                offset_b -= sb[d] * extent[d];
+                index[d] = 0;
+            }
+        }
+    }
+
+    static void Relu(const float *in, float *out, size_t n) {
+        Visit([&](auto kernel) { decltype(kernel)::Relu(in, out, n); });
+    }
+
+    // Raw kernels of the active ISA, for callers that resolve them once up front
+    // (see ExecutionPlan); same contracts as Binary() and Relu() over n > 0 elements
+    using BinaryKernel = void (*)(const float *, const float *, float *, size_t, bool);
+    using UnaryKernel = void (*)(const float *, float *, size_t);
+
+    // Binary kernel, a broadcast operand being one value
+    static BinaryKernel Kernel(ElementwiseOp op, bool broadcast_a, bool broadcast_b) {
+        BinaryKernel kernel = nullptr;
+        Visit([&](auto kernels) {
+            using Kernels = decltype(kernels);
+            switch (op) {
+                case ElementwiseOp::Add: kernel = Select<Kernels, ElementwiseOp::Add>(broadcast_a, broadcast_b); break;
+                case ElementwiseOp::Sub: kernel = Select<Kernels, ElementwiseOp::Sub>(broadcast_a, broadcast_b); break;
+                case ElementwiseOp::Mul: kernel = Select<Kernels, ElementwiseOp::Mul>(broadcast_a, broadcast_b); break;
+            }
+        });
+        return kernel;
+    }
+
+    static UnaryKernel ReluKernel() {
+        UnaryKernel kernel = nullptr;
+        Visit([&](auto kernels) { kernel = &decltype(kernels)::Relu; });
+        return kernel;
+    }
+
+private:
+    enum class Isa { Scalar, Neon, Avx2, Avx512 };
+
+    template <typename Kernels, ElementwiseOp Op>
+    static BinaryKernel Select(bool broadcast_a, bool broadcast_b) {
+        if (broadcast_a && broadcast_b) return &Kernels::template Binary<Op, true, true>;
+        if (broadcast_a) return &Kernels::template Binary<Op, true, false>;
+        if (broadcast_b) return &Kernels::template Binary<Op, false, true>;
+        return &Kernels::template Binary<Op, false, false>;
+    }
+
+    template <typename Visitor>
+    static void Visit(const Visitor &visitor) {
+        static const Isa isa = Detect();
+        switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+            case Isa::Avx512: return visitor(ElementwiseKernelAvx512());
+            case Isa::Avx2: return visitor(ElementwiseKernelAvx2());
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+            case Isa::Neon: return visitor(ElementwiseKernelNeon());
+#endif
+            default: return visitor(ElementwiseKernelScalar());
+        }
+    }
+
+    static Isa Detect() {
+        const CpuFeatures &cpu = CpuFeatures::Get();
+        if (cpu.avx512f) return Isa::Avx512;
+        if (cpu.avx2) return Isa::Avx2;
+        if (cpu.neon) return Isa::Neon;
+        return Isa::Scalar;
+    }
+};
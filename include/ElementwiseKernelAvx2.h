@@ -0,0 +1,63 @@
+#include <cstddef>
+#include "ElementwiseOp.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 elementwise kernels, see Elementwise.h. Two vectors per iteration,
+// scalar tail. Compiled with a target attribute so the rest of the binary
+// stays baseline x86-64.
+class ElementwiseKernelAvx2 {
+public:
+    static constexpr size_t kLanes = 8;
+
+    // A broadcast operand is one value read for every element
+    template <ElementwiseOp Op, bool BroadcastA, bool BroadcastB>
+    __attribute__((target("avx2")))
+    static void Binary(const float *a, const float *b, float *out, size_t n, bool relu) {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 a1 = _mm256_set1_ps(*a), b1 = _mm256_set1_ps(*b);
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            __m256 lo = Apply<Op>(BroadcastA ? a1 : _mm256_loadu_ps(a + i), BroadcastB ? b1 : _mm256_loadu_ps(b + i));
+            __m256 hi = Apply<Op>(BroadcastA ? a1 : _mm256_loadu_ps(a + i + kLanes), BroadcastB ? b1 : _mm256_loadu_ps(b + i + kLanes));
+            if (relu) {
+                lo = _mm256_max_ps(lo, zero);
+                hi = _mm256_max_ps(hi, zero);
+            }
+            _mm256_storeu_ps(out + i, lo);
+            _mm256_storeu_ps(out + i + kLanes, hi);
+        }
+        for (; i < n; ++i) {
+            const float value = ApplyElementwise<Op>(a[BroadcastA ? 0 : i], b[BroadcastB ? 0 : i]);
+            out[i] = relu ? ApplyRelu(value) : value;
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static void Relu(const float *in, float *out, size_t n) {
+        const __m256 zero = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_loadu_ps(in + i), zero));
+            _mm256_storeu_ps(out + i + kLanes, _mm256_max_ps(_mm256_loadu_ps(in + i + kLanes), zero));
+        }
+        for (; i < n; ++i) out[i] = ApplyRelu(in[i]);
+    }
+
+private:
+    template <ElementwiseOp Op>
+    __attribute__((target("avx2")))
+    static __m256 Apply(__m256 a, __m256 b) {
+        if constexpr (Op == ElementwiseOp::Add) return _mm256_add_ps(a, b);
+        if constexpr (Op == ElementwiseOp::Sub) return _mm256_sub_ps(a, b);
+        if constexpr (Op == ElementwiseOp::Mul) return _mm256_mul_ps(a, b);
+    }
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include <cstddef>
+#include "ElementwiseOp.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX-512F elementwise kernels, see Elementwise.h. Two vectors per iteration,
+// the tail in one masked vector. Compiled with a target attribute so the rest
+// of the binary stays baseline x86-64.
+class ElementwiseKernelAvx512 {
+public:
+    static constexpr size_t kLanes = 16;
+
+    // A broadcast operand is one value read for every element
+    template <ElementwiseOp Op, bool BroadcastA, bool BroadcastB>
+    __attribute__((target("avx512f")))
+    static void Binary(const float *a, const float *b, float *out, size_t n, bool relu) {
+        const __m512 zero = _mm512_setzero_ps();
+        const __m512 a1 = _mm512_set1_ps(*a), b1 = _mm512_set1_ps(*b);
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            __m512 lo = Apply<Op>(BroadcastA ? a1 : _mm512_loadu_ps(a + i), BroadcastB ? b1 : _mm512_loadu_ps(b + i));
+            __m512 hi = Apply<Op>(BroadcastA ? a1 : _mm512_loadu_ps(a + i + kLanes), BroadcastB ? b1 : _mm512_loadu_ps(b + i + kLanes));
+            if (relu) {
+                lo = _mm512_max_ps(lo, zero);
+                hi = _mm512_max_ps(hi, zero);
+            }
+            _mm512_storeu_ps(out + i, lo);
+            _mm512_storeu_ps(out + i + kLanes, hi);
+        }
+        for (; i < n; i += kLanes) {
+            const __mmask16 mask = Mask(n - i);
+            __m512 value = Apply<Op>(BroadcastA ? a1 : _mm512_maskz_loadu_ps(mask, a + i),
+                                     BroadcastB ? b1 : _mm512_maskz_loadu_ps(mask, b + i));
+            if (relu) value = _mm512_max_ps(value, zero);
+            _mm512_mask_storeu_ps(out + i, mask, value);
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void Relu(const float *in, float *out, size_t n) {
+        const __m512 zero = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            _mm512_storeu_ps(out + i, _mm512_max_ps(_mm512_loadu_ps(in + i), zero));
+            _mm512_storeu_ps(out + i + kLanes, _mm512_max_ps(_mm512_loadu_ps(in + i + kLanes), zero));
+        }
+        for (; i < n; i += kLanes) {
+            const __mmask16 mask = Mask(n - i);
+            _mm512_mask_storeu_ps(out + i, mask, _mm512_max_ps(_mm512_maskz_loadu_ps(mask, in + i), zero));
+        }
+    }
+
+private:
+    // First min(count, 16) lanes
+    static __mmask16 Mask(size_t count) {
+        return count >= kLanes ? __mmask16(0xffff) : static_cast<__mmask16>((1u << count) - 1);
+    }
+
+    template <ElementwiseOp Op>
+    __attribute__((target("avx512f")))
+    static __m512 Apply(__m512 a, __m512 b) {
+        if constexpr (Op == ElementwiseOp::Add) return _mm512_add_ps(a, b);
+        if constexpr (Op == ElementwiseOp::Sub) return _mm512_sub_ps(a, b);
+        if constexpr (Op == ElementwiseOp::Mul) return _mm512_mul_ps(a, b);
+    }
+};
+
+#endif
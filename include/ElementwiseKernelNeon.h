@@ -0,0 +1,59 @@
+#include <cstddef>
+#include "ElementwiseOp.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#pragma once
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+// NEON elementwise kernels, see Elementwise.h. Two q registers per
+// iteration, scalar tail.
+class ElementwiseKernelNeon {
+public:
+    static constexpr size_t kLanes = 4;
+
+    // A broadcast operand is one value read for every element
+    template <ElementwiseOp Op, bool BroadcastA, bool BroadcastB>
+    static void Binary(const float *a, const float *b, float *out, size_t n, bool relu) {
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t a1 = vdupq_n_f32(*a), b1 = vdupq_n_f32(*b);
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            float32x4_t lo = Apply<Op>(BroadcastA ? a1 : vld1q_f32(a + i), BroadcastB ? b1 : vld1q_f32(b + i));
+            float32x4_t hi = Apply<Op>(BroadcastA ? a1 : vld1q_f32(a + i + kLanes), BroadcastB ? b1 : vld1q_f32(b + i + kLanes));
+            if (relu) {
+                lo = vmaxq_f32(lo, zero);
+                hi = vmaxq_f32(hi, zero);
+            }
+            vst1q_f32(out + i, lo);
+            vst1q_f32(out + i + kLanes, hi);
+        }
+        for (; i < n; ++i) {
+            const float value = ApplyElementwise<Op>(a[BroadcastA ? 0 : i], b[BroadcastB ? 0 : i]);
+            out[i] = relu ? ApplyRelu(value) : value;
+        }
+    }
+
+    static void Relu(const float *in, float *out, size_t n) {
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            vst1q_f32(out + i, vmaxq_f32(vld1q_f32(in + i), zero));
+            vst1q_f32(out + i + kLanes, vmaxq_f32(vld1q_f32(in + i + kLanes), zero));
+        }
+        for (; i < n; ++i) out[i] = ApplyRelu(in[i]);
+    }
+
+private:
+    template <ElementwiseOp Op>
+    static float32x4_t Apply(float32x4_t a, float32x4_t b) {
+        if constexpr (Op == ElementwiseOp::Add) return vaddq_f32(a, b);
+        if constexpr (Op == ElementwiseOp::Sub) return vsubq_f32(a, b);
+        if constexpr (Op == ElementwiseOp::Mul) return vmulq_f32(a, b);
+    }
+};
+
+#endif
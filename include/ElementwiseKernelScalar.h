@@ -0,0 +1,22 @@
+#include <cstddef>
+#include "ElementwiseOp.h"
+
+#pragma once
+
+// Portable elementwise kernels, see Elementwise.h; plain loops over raw
+// pointers that the compiler vectorizes for the baseline ISA
+class ElementwiseKernelScalar {
+public:
+    // A broadcast operand is one value read for every element
+    template <ElementwiseOp Op, bool BroadcastA, bool BroadcastB>
+    static void Binary(const float *a, const float *b, float *out, size_t n, bool relu) {
+        for (size_t i = 0; i < n; ++i) {
+            const float value = ApplyElementwise<Op>(a[BroadcastA ? 0 : i], b[BroadcastB ? 0 : i]);
+            out[i] = relu ? ApplyRelu(value) : value;
+        }
+    }
+
+    static void Relu(const float *in, float *out, size_t n) {
+        for (size_t i = 0; i < n; ++i) out[i] = ApplyRelu(in[i]);
+    }
+};
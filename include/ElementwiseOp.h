@@ -0,0 +1,20 @@
+#include <algorithm>
+
+#pragma once
+
+// Binary operations of the elementwise kernels, see Elementwise.h
+enum class ElementwiseOp {
+    Add,
+    Sub,
+    Mul
+};
+
+// One element, for reference code and the tails of the SIMD kernels
+template <ElementwiseOp Op>
+inline float ApplyElementwise(float a, float b) {
+    if constexpr (Op == ElementwiseOp::Add) return a + b;
+    if constexpr (Op == ElementwiseOp::Sub) return a - b;
+    if constexpr (Op == ElementwiseOp::Mul) return a * b;
+}
+
+inline float ApplyRelu(float x) { return std::max(0.0f, x); }
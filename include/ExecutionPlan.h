@@ -0,0 +1,157 @@
+#include "Executor.h"
+#include "MemoryPlanner.h"
+#include <memory>
+
+#pragma once
+
+// Immutable, flattened form of a scheduled, fused and laid out Executor, built
+// by NeuralNetwork::compile(). Every step that does work becomes one Op record
+// with its operands and output resolved to tensors and its kernel selected, so
+// run() is a loop over a contiguous array: shapes were checked while planning,
+// and elementwise ops and ReLU call their SIMD kernel directly instead of going
+// through INode. Other ops (MatMul, Conv, Softmax, ...) keep one virtual
+// compute() call, negligible next to their work.
+//
+// The plan owns its arena and keeps the graph alive. Graph inputs may get new
+// values of the same shape and layout; anything else, like new weights or a
+// new quantization, needs a new plan. run() must not be called concurrently.
+class ExecutionPlan {
+public:
+    struct Op {
+        void (*run)(const Op&);
+        const INode* node;
+        Tensor* output;
+        size_t size = 0;                           // output elements, direct kernels only
+        const Tensor* operands[2] = {};            // direct kernels only
+        Elementwise::BinaryKernel binary = nullptr;
+        Elementwise::UnaryKernel unary = nullptr;
+        const std::vector<const Tensor*>* args = nullptr; // node operands, for compute()
+        Epilogue epilogue;
+    };
+
+    // graph and storage (e.g. a mapped model file) are kept alive with the plan
+    ExecutionPlan(Executor executor, std::vector<std::shared_ptr<INode>> graph, std::vector<std::shared_ptr<const void>> storage = {})
+        : storage_(std::move(storage)), executor_(std::move(executor)), graph_(std::move(graph)) {
+        memory_ = MemoryPlanner::Plan(executor_);
+        // Allocator buffers start at a 64-byte boundary, as the plan offsets assume
+        arena_ = Tensor({memory_.arena_size}, Tensor::Uninitialized());
+        slots_ = executor_.bind(memory_, arena_.data());
+
+        const std::vector<Executor::Step>& schedule = executor_.schedule();
+        args_.reserve(schedule.size());
+        for (size_t i = 0; i < schedule.size(); ++i) {
+            const Executor::Step& step = schedule[i];
+            if (step.skipped) continue;
+            if (const Tensor* held = step.node->value()) {
+                inputs_.push_back({held, held->shape(), held->layout(), held->dtype()});
+                continue;
+            }
+
+            std::vector<const Tensor*>& args = args_.emplace_back();
+            for (size_t input : step.inputs) args.push_back(result(input));
+            Op op{&RunNode, step.node, &slots_[i]};
+            op.epilogue.addend = step.addend;
+            op.epilogue.relu = step.relu;
+            if (step.addend_is_input) {
+                op.epilogue.addend = args.back();
+                args.pop_back();
+            }
+            op.args = &args;
+            if (op.epilogue.empty()) SelectKernel(op);
+            ops_.push_back(op);
+        }
+        output_ = result(executor_.outputs().front());
+    }
+
+    ExecutionPlan(const ExecutionPlan&) = delete;
+    ExecutionPlan& operator=(const ExecutionPlan&) = delete;
+
+    // Runs every op and returns the graph output, valid until the next run()
+    const Tensor& run() const {
+        for (const Input& input : inputs_) {
+            if (input.tensor->shape() != input.shape || input.tensor->layout() != input.layout || input.tensor->dtype() != input.dtype)
+                throw std::invalid_argument("A graph input changed its shape, layout or type since the plan was compiled");
+        }
+        for (const Op& op : ops_) op.run(op);
+        return *output_;
+    }
+
+    // Op records in execution order
+    const std::vector<Op>& ops() const { return ops_; }
+
+    // Ops that run their kernel directly, without INode::compute()
+    size_t directOps() const {
+        return std::count_if(ops_.begin(), ops_.end(), [](const Op& op) { return op.run != &RunNode; });
+    }
+
+    const MemoryPlan& memoryPlan() const { return memory_; }
+
+private:
+    struct Input {
+        const Tensor* tensor;
+        std::vector<size_t> shape;
+        Layout layout;
+        DType dtype;
+    };
+
+    std::vector<std::shared_ptr<const void>> storage_; // outlives the nodes
+    Executor executor_;
+    std::vector<std::shared_ptr<INode>> graph_;
+    MemoryPlan memory_;
+    Tensor arena_;
+    std::vector<Tensor> slots_;
+    std::vector<std::vector<const Tensor*>> args_; // reserved up front, ops point into it
+    std::vector<Op> ops_;
+    std::vector<Input> inputs_;
+    const Tensor* output_ = nullptr;
+
+    const Tensor* result(size_t pos) const {
+        const Tensor* held = executor_.schedule()[pos].node->value();
+        return held ? held : &slots_[pos];
+    }
+
+    // Direct kernel for f32 elementwise ops whose operands are stored exactly
+    // like the output; broadcasts, reorders and 16-bit operands stay on compute()
+    static void SelectKernel(Op& op) {
+        const Tensor& output = *op.output;
+        const auto matches = [&](const Tensor* operand) {
+            return operand->dtype() == DType::F32 && operand->shape() == output.shape() && operand->layout() == output.layout();
+        };
+        if (output.size() == 0) return;
+
+        const OpKind kind = op.node->kind();
+        if (kind == OpKind::ReLU && op.args->size() == 1 && matches(op.args->front())) {
+            op.operands[0] = op.args->front();
+            op.unary = Elementwise::ReluKernel();
+            op.run = &RunUnary;
+        } else if (kind == OpKind::Add || kind == OpKind::Sub || kind == OpKind::Mul) {
+            const auto* binary = dynamic_cast<const BinaryOperation*>(op.node);
+            if (!binary) return;
+            const std::vector<const Tensor*>& args = *op.args;
+            const Tensor* lhs = binary->lhsTensor() ? binary->lhsTensor() : args[0];
+            const Tensor* rhs = binary->rhsTensor() ? binary->rhsTensor() : args[binary->lhsTensor() ? 0 : 1];
+            if (!matches(lhs) || !matches(rhs)) return;
+            const ElementwiseOp elementwise = kind == OpKind::Add ? ElementwiseOp::Add : kind == OpKind::Sub ? ElementwiseOp::Sub : ElementwiseOp::Mul;
+            op.operands[0] = lhs;
+            op.operands[1] = rhs;
+            op.binary = Elementwise::Kernel(elementwise, false, false);
+            op.run = &RunBinary;
+        } else {
+            return;
+        }
+        op.size = output.size();
+    }
+
+    static void RunBinary(const Op& op) {
+        op.binary(op.operands[0]->data(), op.operands[1]->data(), op.output->data(), op.size, false);
+    }
+
+    static void RunUnary(const Op& op) {
+        op.unary(op.operands[0]->data(), op.output->data(), op.size);
+    }
+
+    static void RunNode(const Op& op) {
+        if (op.epilogue.empty()) op.node->compute(*op.args, *op.output);
+        else op.node->compute(*op.args, *op.output, op.epilogue);
+    }
+};
@@ -0,0 +1,320 @@
+#include "Operations.h"
+#include "MemoryPlan.h"
+#include "ThreadPool.h"
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#pragma once
+
+// Evaluates the subgraph reachable from a set of output nodes, each node exactly
+// once, in topological order. A node result is released as soon as its last
+// consumer has run, so shared subgraphs (residuals, fan-out) cost one evaluation.
+class Executor {
+public:
+    struct Step {
+        INode* node;
+        std::vector<size_t> inputs; // schedule positions of node->inputs()
+        size_t uses;                // consumers in the schedule, +1 per output reference
+
+        // Set by fusion passes (see EpilogueFusion)
+        bool skipped = false;           // folded into a later step, produces nothing
+        const Tensor* addend = nullptr; // constant epilogue addend
+        bool addend_is_input = false;   // epilogue addend is the result of inputs.back()
+        bool relu = false;              // epilogue ReLU
+
+        // Set by LayoutAssignment
+        Layout layout = Layout::NCHW;   // storage layout of the result
+
+        // Operands of node->inputs(), i.e. inputs without a fused addend
+        size_t nodeInputs() const { return addend_is_input ? inputs.size() - 1 : inputs.size(); }
+    };
+
+    Executor() = default;
+
+    explicit Executor(const std::vector<INode*>& outputs) {
+        std::unordered_map<INode*, size_t> position;
+
+        // Iterative post-order DFS, so deep graphs do not overflow the stack
+        for (INode* output : outputs) {
+            std::vector<std::pair<INode*, size_t>> stack = {{output, 0}};
+            while (!stack.empty()) {
+                auto& [node, next_input] = stack.back();
+                if (position.count(node)) {
+                    stack.pop_back();
+                    continue;
+                }
+                const std::vector<INode*> node_inputs = node->inputs();
+                if (next_input < node_inputs.size()) {
+                    INode* input = node_inputs[next_input++];
+                    if (!position.count(input)) stack.push_back({input, 0});
+                    continue;
+                }
+
+                Step step{node, {}, 0};
+                for (INode* input : node_inputs) {
+                    const size_t pos = position.at(input);
+                    step.inputs.push_back(pos);
+                    schedule_[pos].uses++;
+                }
+                position[node] = schedule_.size();
+                schedule_.push_back(std::move(step));
+                stack.pop_back();
+            }
+            const size_t pos = position.at(output);
+            schedule_[pos].uses++;
+            outputs_.push_back(pos);
+        }
+    }
+
+    // Topologically ordered steps
+    const std::vector<Step>& schedule() const { return schedule_; }
+
+    // For graph passes that rewrite the schedule in place
+    std::vector<Step>& schedule() { return schedule_; }
+
+    // Schedule positions of the requested outputs
+    const std::vector<size_t>& outputs() const { return outputs_; }
+
+    std::vector<size_t>& outputs() { return outputs_; }
+
+    // Result shape of every step for the current graph inputs; throws on mismatch.
+    // Skipped steps get an empty shape.
+    std::vector<std::vector<size_t>> inferShapes() const {
+        std::vector<std::vector<size_t>> shapes(schedule_.size());
+        for (size_t i = 0; i < schedule_.size(); ++i) {
+            const Step& step = schedule_[i];
+            if (step.skipped) continue;
+            if (const Tensor* held = step.node->value()) {
+                shapes[i] = held->shape();
+                continue;
+            }
+            std::vector<std::vector<size_t>> arg_shapes;
+            for (size_t k = 0; k < step.nodeInputs(); ++k) arg_shapes.push_back(shapes[step.inputs[k]]);
+            shapes[i] = step.node->outputShape(arg_shapes);
+        }
+        return shapes;
+    }
+
+    // For graph passes that add nodes of their own: the executor keeps them alive
+    INode* adopt(std::shared_ptr<INode> node) {
+        owned_.push_back(node);
+        return node.get();
+    }
+
+    std::vector<Tensor> run() const {
+        std::vector<Tensor> values(schedule_.size());
+        std::vector<size_t> remaining(schedule_.size());
+        std::vector<const Tensor*> args;
+
+        for (size_t i = 0; i < schedule_.size(); ++i) {
+            const Step& step = schedule_[i];
+            remaining[i] = step.uses;
+
+            if (!step.skipped && !step.node->value()) {
+                Epilogue epilogue;
+                Gather(step, values, args, epilogue);
+                const size_t reused = InPlaceOperand(step, values, args, remaining);
+                if (reused == kNoOperand) {
+                    values[i] = step.node->compute(args, epilogue, step.layout);
+                } else {
+                    // The result takes over the operand's buffer
+                    values[i] = std::move(values[step.inputs[reused]]);
+                    args[reused] = &values[i];
+                    if (epilogue.empty()) step.node->compute(args, values[i]);
+                    else step.node->compute(args, values[i], epilogue);
+                }
+            }
+
+            // Release intermediates whose last consumer just ran
+            for (size_t input : step.inputs) {
+                if (--remaining[input] == 0) values[input] = Tensor();
+            }
+        }
+
+        std::vector<Tensor> results;
+        for (size_t output : outputs_) {
+            const Tensor* result = Result(values, output);
+            results.push_back(--remaining[output] == 0 && result == &values[output] ? std::move(values[output]) : *result);
+        }
+        return results;
+    }
+
+    // One tensor per step over its planned arena slot (empty for graph inputs)
+    std::vector<Tensor> bind(const MemoryPlan& plan, float* arena) const {
+        std::vector<Tensor> slots(schedule_.size());
+        for (size_t i = 0; i < schedule_.size(); ++i) {
+            if (plan.offsets[i] != MemoryPlan::kNoBuffer) slots[i] = Tensor::Wrap(plan.shapes[i], arena + plan.offsets[i], plan.layouts[i]);
+        }
+        return slots;
+    }
+
+    // Runs into tensors from bind(); no intermediate result is allocated.
+    // Outputs are read with result(slots, outputs()[i]).
+    // With max_parallel > 1, independent steps run concurrently on the shared
+    // ThreadPool as soon as their inputs are ready; the plan must then come from
+    // MemoryPlanner::Plan(executor, true).
+    void run(std::vector<Tensor>& slots, size_t max_parallel = 1) const {
+        max_parallel = std::min(max_parallel, ThreadPool::Shared().NumThreads());
+        if (max_parallel > 1) {
+            RunParallel(slots, max_parallel);
+            return;
+        }
+
+        std::vector<const Tensor*> args;
+        args.reserve(4);
+        for (size_t i = 0; i < schedule_.size(); ++i) {
+            const Step& step = schedule_[i];
+            if (step.skipped || step.node->value()) continue;
+            Epilogue epilogue;
+            Gather(step, slots, args, epilogue);
+            if (epilogue.empty()) step.node->compute(args, slots[i]);
+            else step.node->compute(args, slots[i], epilogue);
+        }
+    }
+
+    const Tensor& result(const std::vector<Tensor>& slots, size_t pos) const { return *Result(slots, pos); }
+
+private:
+    std::vector<Step> schedule_;
+    std::vector<size_t> outputs_;
+    std::vector<std::shared_ptr<INode>> owned_;
+
+    // Dependency-driven run: a step is queued once its last input completes, and at
+    // most max_parallel steps are in flight. Steps without work complete inline.
+    struct ParallelRun {
+        std::vector<std::vector<size_t>> consumers;
+        std::unique_ptr<std::atomic<size_t>[]> pending;
+        std::atomic<size_t> remaining{0};
+
+        std::mutex mutex;
+        std::vector<size_t> ready;
+        size_t running = 0;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+    };
+
+    void RunParallel(std::vector<Tensor>& slots, size_t max_parallel) const {
+        const size_t steps = schedule_.size();
+        ParallelRun state;
+        state.consumers.resize(steps);
+        state.pending.reset(new std::atomic<size_t>[steps]);
+        state.remaining = steps;
+        for (size_t i = 0; i < steps; ++i) {
+            state.pending[i] = schedule_[i].inputs.size();
+            for (size_t input : schedule_[i].inputs) state.consumers[input].push_back(i);
+        }
+
+        for (size_t i = 0; i < steps; ++i) {
+            if (schedule_[i].inputs.empty()) MakeReady(state, i);
+        }
+        Launch(state, slots, max_parallel);
+
+        // The caller helps with queued work until every step completed
+        ThreadPool& pool = ThreadPool::Shared();
+        while (state.remaining > 0) {
+            if (!pool.RunPendingTask()) std::this_thread::yield();
+        }
+        if (state.error) std::rethrow_exception(state.error);
+    }
+
+    void MakeReady(ParallelRun& state, size_t pos) const {
+        const Step& step = schedule_[pos];
+        if (step.skipped || step.node->value()) {
+            Complete(state, pos);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.ready.push_back(pos);
+    }
+
+    void Complete(ParallelRun& state, size_t pos) const {
+        Release(state, pos);
+        state.remaining--;
+    }
+
+    void Release(ParallelRun& state, size_t pos) const {
+        for (size_t consumer : state.consumers[pos]) {
+            if (--state.pending[consumer] == 0) MakeReady(state, consumer);
+        }
+    }
+
+    void Launch(ParallelRun& state, std::vector<Tensor>& slots, size_t max_parallel) const {
+        // Submit outside the lock: without workers the pool runs the task inline
+        std::vector<size_t> launch;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            while (state.running < max_parallel && !state.ready.empty()) {
+                launch.push_back(state.ready.back());
+                state.ready.pop_back();
+                state.running++;
+            }
+        }
+        for (size_t pos : launch) {
+            ThreadPool::Shared().Submit([this, &state, &slots, max_parallel, pos]() {
+                if (!state.failed) {
+                    try {
+                        const Step& step = schedule_[pos];
+                        std::vector<const Tensor*> args;
+                        Epilogue epilogue;
+                        Gather(step, slots, args, epilogue);
+                        if (epilogue.empty()) step.node->compute(args, slots[pos]);
+                        else step.node->compute(args, slots[pos], epilogue);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(state.mutex);
+                        if (!state.error) state.error = std::current_exception();
+                        state.failed = true;
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    state.running--;
+                }
+                Release(state, pos);
+                Launch(state, slots, max_parallel);
+                // Last touch of state: the caller may return right after it
+                state.remaining--;
+            });
+        }
+    }
+
+    static constexpr size_t kNoOperand = static_cast<size_t>(-1);
+
+    // Node operand (an args index) whose buffer the step can write its result into:
+    // an intermediate of the result's shape and layout read by nothing after this step
+    size_t InPlaceOperand(const Step& step, const std::vector<Tensor>& values,
+                          const std::vector<const Tensor*>& args, const std::vector<size_t>& remaining) const {
+        if (!step.node->computesInPlace()) return kNoOperand;
+        std::vector<std::vector<size_t>> arg_shapes;
+        for (const Tensor* arg : args) arg_shapes.push_back(arg->shape());
+        const std::vector<size_t> shape = step.node->outputShape(arg_shapes);
+        for (size_t k = 0; k < step.nodeInputs(); ++k) {
+            const size_t input = step.inputs[k];
+            if (args[k] != &values[input] || remaining[input] != 1) continue;
+            if (args[k]->shape() != shape || args[k]->layout() != step.layout) continue;
+            return k;
+        }
+        return kNoOperand;
+    }
+
+    const Tensor* Result(const std::vector<Tensor>& values, size_t pos) const {
+        const Tensor* held = schedule_[pos].node->value();
+        return held ? held : &values[pos];
+    }
+
+    // Operands of a step and its fused epilogue
+    void Gather(const Step& step, const std::vector<Tensor>& values,
+                std::vector<const Tensor*>& args, Epilogue& epilogue) const {
+        args.clear();
+        for (size_t input : step.inputs) args.push_back(Result(values, input));
+        epilogue.addend = step.addend;
+        epilogue.relu = step.relu;
+        if (step.addend_is_input) {
+            epilogue.addend = args.back();
+            args.pop_back();
+        }
+    }
+};
@@ -1,13 +1,32 @@
 #include "Tensor.h"
-#include <arm_neon.h>
+#include "TensorView.h"
+#include "CpuFeatures.h"
+#include "GemmKernelScalar.h"
+#include "GemmKernelNeon.h"
+#include "GemmKernelAvx2.h"
+#include "GemmKernelAvx512.h"
+#include "BlockedGemm.h"
+#include "SmallGemm.h"
+#include "SmallGemmKernelScalar.h"
+#include "SmallGemmKernelAvx2.h"
+#include "SmallGemmKernelAvx512.h"
+#include "ThreadPool.h"
+#include <algorithm>
 
 #pragma once
 
-class MatrixMultiplyNeon {
+enum class GemmBackend {
+    Scalar,
+    Neon,
+    Avx2,
+    Avx512
+};
+
+class FastMatMul {
 public:
     static void MatrixMultiplyFast(
-        const std::vector<float>& A, 
-        const std::vector<float>& B, 
+        const std::vector<float>& A,
+        const std::vector<float>& B,
         std::vector<float>& C,
         uint32_t n, uint32_t m, uint32_t k);
 
@@ -16,95 +35,353 @@ public:
         const std::vector<float>& B,
         uint32_t n, uint32_t m, uint32_t k);
 
+    // Kernel used by MatrixMultiplyFast, picked from CPUID on first use
+    static GemmBackend GetBackend() { return ActiveBackend(); }
+
+    // Force a backend (e.g. to compare kernels); must be available on this host
+    static void SetBackend(GemmBackend backend) {
+        if (!IsBackendAvailable(backend)) throw std::invalid_argument("GEMM backend is not supported on this CPU");
+        ActiveBackend() = backend;
+    }
+
+    // Threads a single GEMM may use; 1 (the default) keeps it on the calling thread
+    static size_t GetNumThreads() { return ActiveThreads(); }
+
+    static void SetNumThreads(size_t num_threads) {
+        if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+        if (ThreadPool::Shared().NumThreads() < num_threads) ThreadPool::Shared().Resize(num_threads);
+        ActiveThreads() = num_threads;
+    }
+
+    static bool IsBackendAvailable(GemmBackend backend) {
+        const CpuFeatures& cpu = CpuFeatures::Get();
+        switch (backend) {
+            case GemmBackend::Scalar: return true;
+            case GemmBackend::Neon:   return cpu.neon;
+            case GemmBackend::Avx2:   return cpu.avx2 && cpu.fma;
+            case GemmBackend::Avx512: return cpu.avx512f;
+        }
+        return false;
+    }
+
+    static GemmBackend BestBackend() {
+        if (IsBackendAvailable(GemmBackend::Avx512)) return GemmBackend::Avx512;
+        if (IsBackendAvailable(GemmBackend::Avx2)) return GemmBackend::Avx2;
+        if (IsBackendAvailable(GemmBackend::Neon)) return GemmBackend::Neon;
+        return GemmBackend::Scalar;
+    }
+
+    static const char* BackendName(GemmBackend backend) {
+        switch (backend) {
+            case GemmBackend::Scalar: return "scalar";
+            case GemmBackend::Neon:   return "neon";
+            case GemmBackend::Avx2:   return "avx2";
+            case GemmBackend::Avx512: return "avx512";
+        }
+        return "unknown";
+    }
+
+    // Strided core behind every entry point: C(n x m, column-major, ldc) = A * B,
+    // element (i, p) of A at A[i * rsa + p * csa], element (p, j) of B at B[p * rsb + j * csb]
+    static void Gemm(
+        size_t n, size_t m, size_t k,
+        const float *A, size_t rsa, size_t csa,
+        const float *B, size_t rsb, size_t csb,
+        float *C, size_t ldc,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        Dispatch(n, m, k, A, rsa, csa, B, rsb, csb, C, ldc, GetNumThreads(), epilogue);
+    }
+
+    // Gemm with A produced by a packing source (see StridedMatrix in BlockedGemm.h)
+    // rather than read from memory, e.g. convolution patches gathered on the fly
+    template <typename ASource>
+    static void GemmImplicit(
+        size_t n, size_t m, size_t k,
+        const ASource &A,
+        const float *B, size_t rsb, size_t csb,
+        float *C, size_t ldc,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        Dispatch(n, m, k, A, B, rsb, csb, C, ldc, GetNumThreads(), epilogue);
+    }
+
+    // Right operand packed once into the micro-panels of the backend active at
+    // packing time, for GEMMs that reuse it (e.g. constant weights). Holds batch
+    // k x m matrices, one per GEMM of a batch, or a single one they all share.
+    struct PackedMatrix {
+        GemmBackend backend = GemmBackend::Scalar;
+        size_t batch = 1;
+        size_t k = 0;
+        size_t m = 0;
+        Tensor panels;
+    };
+
+    // B (k x m), element (p, j) at B[p * rsb + j * csb]
+    static PackedMatrix Prepack(size_t k, size_t m, const float *B, size_t rsb, size_t csb) {
+        return PrepackBatched(1, k, m, B, rsb, csb, 0);
+    }
+
+    // batch matrices B_b starting at B + b * batch_stride_b, panels stored as
+    // storage: bf16/f16 panels take half the memory and are widened block by
+    // block while the GEMM runs
+    static PackedMatrix PrepackBatched(size_t batch, size_t k, size_t m, const float *B, size_t rsb, size_t csb,
+                                       size_t batch_stride_b, DType storage = DType::F32) {
+        PackedMatrix packed;
+        packed.backend = GetBackend();
+        packed.batch = batch;
+        packed.k = k;
+        packed.m = m;
+        VisitBackend(packed.backend, [&](auto gemm) {
+            using Gemm = decltype(gemm);
+            const size_t size = Gemm::PackedSize(k, m);
+            packed.panels = Tensor({batch * size}, storage, Tensor::Uninitialized());
+            if (storage == DType::F32) {
+                for (size_t b = 0; b < batch; ++b) Gemm::Prepack(k, m, B + b * batch_stride_b, rsb, csb, packed.panels.data() + b * size);
+                return;
+            }
+            std::vector<float> panels(size);
+            for (size_t b = 0; b < batch; ++b) {
+                Gemm::Prepack(k, m, B + b * batch_stride_b, rsb, csb, panels.data());
+                HalfConvert::FromFloat(storage, panels.data(), packed.panels.halfData() + b * size, size);
+            }
+        });
+        return packed;
+    }
+
+    // Active backend and its blocking, {backend, MR, NR, MC, KC, NC}: packed
+    // operands are only valid for the configuration they were packed with
+    static std::vector<size_t> TileConfig() {
+        std::vector<size_t> config;
+        const GemmBackend backend = GetBackend();
+        VisitBackend(backend, [&](auto gemm) {
+            using Gemm = decltype(gemm);
+            config = {static_cast<size_t>(backend), Gemm::kMR, Gemm::kNR, Gemm::kMC, Gemm::kKC, Gemm::kNC};
+        });
+        return config;
+    }
+
+    // Whether n x m x k GEMMs with unit row strides run a shape-specialized
+    // kernel (see SmallGemm.h) instead of the packed blocked one
+    static bool HasSmallKernel(size_t n, size_t m, size_t k) { return SmallKernel(n, m, k) != nullptr; }
+
+    // batch column-major GEMMs C_b(n x B.m) = A_b * B_b sharing one prepacked B (or
+    // with one packed B per item), run as a single parallel GEMM; a_of(b) returns
+    // A_b's packing source and C_b starts at C + b * batch_stride_c. An epilogue
+    // addend follows C's strides, a per-column bias (rs_addend 0) is shared by every item.
+    template <typename ABatch>
+    static void GemmPacked(
+        size_t batch, size_t n,
+        const ABatch &a_of, const PackedMatrix &B,
+        float *C, size_t ldc, size_t batch_stride_c,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        if (B.backend != GetBackend()) throw std::invalid_argument("Packed operand was built for another GEMM backend");
+        if (B.batch != 1 && B.batch != batch) throw std::invalid_argument("Packed operand batch does not match the GEMM batch");
+        if (batch == 0 || n == 0 || B.m == 0) return;
+        if (B.k == 0) {
+            for (size_t b = 0; b < batch; ++b) {
+                const GemmEpilogue item_epilogue = epilogue ? epilogue->Offset(b * batch_stride_c, 0) : GemmEpilogue();
+                FillEmptyProduct(n, B.m, C + b * batch_stride_c, ldc, epilogue ? &item_epilogue : nullptr);
+            }
+            return;
+        }
+        VisitBackend(B.backend, [&](auto gemm) {
+            using Gemm = decltype(gemm);
+            const size_t batch_stride_b = B.batch == 1 ? 0 : Gemm::PackedSize(B.k, B.m);
+            if (B.panels.dtype() == DType::F32) {
+                Gemm::RunPacked(batch, n, B.m, B.k, a_of, PackedPanels{B.panels.data()}, batch_stride_b, C, ldc, batch_stride_c,
+                                GetNumThreads(), epilogue);
+            } else {
+                Gemm::RunPacked(batch, n, B.m, B.k, a_of, HalfPackedPanels{B.panels.halfData(), B.panels.dtype()}, batch_stride_b,
+                                C, ldc, batch_stride_c, GetNumThreads(), epilogue);
+            }
+        });
+    }
+
+    // batch x channels independent column-major GEMMs read from and written to
+    // caller storage: slice (b, c) of X starts at X + b * batch_stride_x + c * channel_stride_x.
+    // Enough slices to feed every thread run one per thread, otherwise each slice is split.
+    // An epilogue addend is laid out like C and follows C's strides.
+    static void GemmStridedBatched(
+        size_t batch, size_t channels,
+        size_t n, size_t m, size_t k,
+        const float *A, size_t lda, size_t batch_stride_a, size_t channel_stride_a,
+        const float *B, size_t ldb, size_t batch_stride_b, size_t channel_stride_b,
+        float *C, size_t ldc, size_t batch_stride_c, size_t channel_stride_c,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        GemmBatched(batch, channels, n, m, k,
+                    A, 1, lda, batch_stride_a, channel_stride_a,
+                    B, 1, ldb, batch_stride_b, channel_stride_b,
+                    C, ldc, batch_stride_c, channel_stride_c, epilogue);
+    }
+
+    // C[b, c, i, j] = sum_p A[b, c, i, p] * B[b, c, p, j] over rank-4 views with any
+    // strides, so sliced or transposed operands are read in place. C needs a unit
+    // stride in one of its last two dimensions; a row-major C is computed as
+    // C^T = B^T * A^T. An epilogue addend is laid out like C (its ld_addend is ignored).
+    static void Gemm(const ConstTensorView& A, const ConstTensorView& B, const TensorView& C,
+                     const GemmEpilogue *epilogue = nullptr) {
+        if (A.rank() != 4 || B.rank() != 4 || C.rank() != 4) throw std::invalid_argument("GEMM views must have rank 4");
+        if (A.shape(0) != B.shape(0) || A.shape(0) != C.shape(0) || A.shape(1) != B.shape(1) || A.shape(1) != C.shape(1))
+            throw std::invalid_argument("GEMM views must have the same batch and channels");
+        if (A.shape(3) != B.shape(2) || C.shape(2) != A.shape(2) || C.shape(3) != B.shape(3))
+            throw std::invalid_argument("Incompatible dimensions for matrix multiplication.");
+
+        const size_t n = C.shape(2), m = C.shape(3), k = A.shape(3);
+        if (C.stride(2) == 1) {
+            GemmBatched(C.shape(0), C.shape(1), n, m, k,
+                        A.data(), A.stride(2), A.stride(3), A.stride(0), A.stride(1),
+                        B.data(), B.stride(2), B.stride(3), B.stride(0), B.stride(1),
+                        C.data(), C.stride(3), C.stride(0), C.stride(1), epilogue);
+        } else if (C.stride(3) == 1) {
+            GemmBatched(C.shape(0), C.shape(1), m, n, k,
+                        B.data(), B.stride(3), B.stride(2), B.stride(0), B.stride(1),
+                        A.data(), A.stride(3), A.stride(2), A.stride(0), A.stride(1),
+                        C.data(), C.stride(2), C.stride(0), C.stride(1), epilogue);
+        } else {
+            throw std::invalid_argument("GEMM output view needs a unit stride in one of its last two dimensions");
+        }
+    }
+
 private:
-    static void inline MatrixMultiply(
-        float32_t *A, 
-        float32_t *B, 
-        float32_t *C, 
-        uint32_t n, 
-        uint32_t m, 
-        uint32_t k
+    // GemmStridedBatched with explicit row and column strides for A and B
+    static void GemmBatched(
+        size_t batch, size_t channels,
+        size_t n, size_t m, size_t k,
+        const float *A, size_t rsa, size_t csa, size_t batch_stride_a, size_t channel_stride_a,
+        const float *B, size_t rsb, size_t csb, size_t batch_stride_b, size_t channel_stride_b,
+        float *C, size_t ldc, size_t batch_stride_c, size_t channel_stride_c,
+        const GemmEpilogue *epilogue
+    ) {
+        const size_t slices = batch * channels;
+        if (slices == 0 || n == 0 || m == 0) return;
+
+        const size_t num_threads = GetNumThreads();
+        const size_t slice_threads = slices >= num_threads ? 1 : num_threads;
+
+        ThreadPool::Shared().ParallelFor(slices, [&](size_t s) {
+            const size_t b = s / channels;
+            const size_t c = s % channels;
+            const size_t c_offset = b * batch_stride_c + c * channel_stride_c;
+            float *C_slice = C + c_offset;
+
+            GemmEpilogue slice_epilogue;
+            if (epilogue) {
+                slice_epilogue = *epilogue;
+                slice_epilogue.ld_addend = ldc;
+                if (epilogue->addend) slice_epilogue.addend = epilogue->addend + c_offset;
+            }
+            Dispatch(n, m, k,
+                     A + b * batch_stride_a + c * channel_stride_a, rsa, csa,
+                     B + b * batch_stride_b + c * channel_stride_b, rsb, csb,
+                     C_slice, ldc, slice_threads, epilogue ? &slice_epilogue : nullptr);
+        }, slice_threads == 1 ? num_threads : 1);
+    }
+
+    static void Dispatch(
+        size_t n, size_t m, size_t k,
+        const float *A, size_t rsa, size_t csa,
+        const float *B, size_t rsb, size_t csb,
+        float *C, size_t ldc,
+        size_t num_threads,
+        const GemmEpilogue *epilogue = nullptr
     ) {
-        int A_idx;
-        int B_idx;
-        int C_idx;
-        
-        // these are the columns of a 4x4 sub matrix of A
-        float32x4_t A0;
-        float32x4_t A1;
-        float32x4_t A2;
-        float32x4_t A3;
-        
-        // these are the columns of a 4x4 sub matrix of B
-        float32x4_t B0;
-        float32x4_t B1;
-        float32x4_t B2;
-        float32x4_t B3;
-        
-        // these are the columns of a 4x4 sub matrix of C
-        float32x4_t C0;
-        float32x4_t C1;
-        float32x4_t C2;
-        float32x4_t C3;
-        
-        for (int i_idx = 0; i_idx < n; i_idx += 4) {
-            for (int j_idx = 0; j_idx < m; j_idx += 4) {
-                // Zero accumulators before matrix op
-                C0 = vmovq_n_f32(0);
-                C1 = vmovq_n_f32(0);
-                C2 = vmovq_n_f32(0);
-                C3 = vmovq_n_f32(0);
-                for (int k_idx = 0; k_idx < k; k_idx += 4) {
-                    // Compute base index to 4x4 block
-                    A_idx = i_idx + n * k_idx;
-                    B_idx = k * j_idx + k_idx;
-                    
-                    // Load most current A values in row 
-                    A0 = vld1q_f32(A + A_idx);
-                    A1 = vld1q_f32(A + A_idx+ n );
-                    A2 = vld1q_f32(A + A_idx + 2 * n);
-                    A3 = vld1q_f32(A + A_idx + 3 * n);
-                    
-                    // Multiply accumulate in 4x1 blocks, i.e. each column in C
-                    B0 = vld1q_f32(B + B_idx);
-                    C0 = vfmaq_laneq_f32(C0, A0, B0, 0);
-                    C0 = vfmaq_laneq_f32(C0, A1, B0, 1);
-                    C0 = vfmaq_laneq_f32(C0, A2, B0, 2);
-                    C0 = vfmaq_laneq_f32(C0, A3, B0, 3);
-                    
-                    B1 = vld1q_f32(B + B_idx + k);
-                    C1 = vfmaq_laneq_f32(C1, A0, B1, 0);
-                    C1 = vfmaq_laneq_f32(C1, A1, B1, 1);
-                    C1 = vfmaq_laneq_f32(C1, A2, B1, 2);
-                    C1 = vfmaq_laneq_f32(C1, A3, B1, 3);
-                    
-                    B2 = vld1q_f32(B + B_idx + 2 * k);
-                    C2 = vfmaq_laneq_f32(C2, A0, B2, 0);
-                    C2 = vfmaq_laneq_f32(C2, A1, B2, 1);
-                    C2 = vfmaq_laneq_f32(C2, A2, B2, 2);
-                    C2 = vfmaq_laneq_f32(C2, A3, B2, 3);
-                    
-                    B3 = vld1q_f32(B + B_idx + 3 * k);
-                    C3 = vfmaq_laneq_f32(C3, A0, B3, 0);
-                    C3 = vfmaq_laneq_f32(C3, A1, B3, 1);
-                    C3 = vfmaq_laneq_f32(C3, A2, B3, 2);
-                    C3 = vfmaq_laneq_f32(C3, A3, B3, 3);
-                }
-                // Compute base index for stores
-                C_idx = n * j_idx + i_idx;
-                vst1q_f32(C + C_idx, C0);
-                vst1q_f32(C + C_idx + n, C1);
-                vst1q_f32(C + C_idx + 2 * n, C2);
-                vst1q_f32(C + C_idx + 3 * n, C3);
+        if (n == 0 || m == 0) return;
+        if (k == 0) return FillEmptyProduct(n, m, C, ldc, epilogue);
+        // Small shapes of the precompiled set skip packing altogether
+        if (rsa == 1 && rsb == 1) {
+            if (const auto kernel = SmallKernel(n, m, k)) {
+                kernel(A, csa, B, csb, C, ldc, epilogue);
+                return;
             }
         }
+        Dispatch(n, m, k, StridedMatrix{A, rsa, csa}, B, rsb, csb, C, ldc, num_threads, epilogue);
+    }
+
+    // Shape-specialized kernel of the active backend's ISA, nullptr for other
+    // shapes. AVX-512 hosts run the AVX2 kernels for row counts below 16.
+    static SmallGemm<SmallGemmKernelScalar>::Function SmallKernel(size_t n, size_t m, size_t k) {
+        switch (GetBackend()) {
+#if defined(__x86_64__) || defined(__i386__)
+            case GemmBackend::Avx512:
+                if (const auto kernel = SmallGemm<SmallGemmKernelAvx512>::Find(n, m, k)) return kernel;
+                if (!IsBackendAvailable(GemmBackend::Avx2)) return nullptr;
+                [[fallthrough]];
+            case GemmBackend::Avx2:
+                return SmallGemm<SmallGemmKernelAvx2>::Find(n, m, k);
+#endif
+            default:
+                return SmallGemm<SmallGemmKernelScalar>::Find(n, m, k);
+        }
+    }
+
+    template <typename ASource>
+    static void Dispatch(
+        size_t n, size_t m, size_t k,
+        const ASource &A,
+        const float *B, size_t rsb, size_t csb,
+        float *C, size_t ldc,
+        size_t num_threads,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        if (n == 0 || m == 0) return;
+        if (k == 0) return FillEmptyProduct(n, m, C, ldc, epilogue);
+        VisitBackend(GetBackend(), [&](auto gemm) {
+            decltype(gemm)::Run(n, m, k, A, B, rsb, csb, C, ldc, num_threads, epilogue);
+        });
+    }
+
+    // A * B with k == 0 is all zeros, so C = epilogue(0); the blocked driver,
+    // which only writes C from its depth loop, never runs
+    static void FillEmptyProduct(size_t n, size_t m, float *C, size_t ldc, const GemmEpilogue *epilogue) {
+        for (size_t j = 0; j < m; ++j)
+            for (size_t i = 0; i < n; ++i)
+                C[i + j * ldc] = epilogue ? epilogue->Apply(0.0f, i, j) : 0.0f;
+    }
+
+    // Calls visit(BlockedGemm<Kernel>()) with the kernel of the given backend
+    template <typename Visitor>
+    static void VisitBackend(GemmBackend backend, Visitor &&visit) {
+        switch (backend) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+            case GemmBackend::Neon:
+                visit(BlockedGemm<GemmKernelNeon>());
+                return;
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+            case GemmBackend::Avx512:
+                visit(BlockedGemm<GemmKernelAvx512>());
+                return;
+            case GemmBackend::Avx2:
+                visit(BlockedGemm<GemmKernelAvx2>());
+                return;
+#endif
+            default:
+                visit(BlockedGemm<GemmKernelScalar>());
+                return;
+        }
+    }
+
+    static GemmBackend& ActiveBackend() {
+        static GemmBackend backend = BestBackend();
+        return backend;
+    }
+
+    static size_t& ActiveThreads() {
+        static size_t num_threads = 1;
+        return num_threads;
     }
 };
 
+// Kept for source compatibility with code written against the NEON-only version
+using MatrixMultiplyNeon = FastMatMul;
+
 
-void MatrixMultiplyNeon::MatrixMultiplyFast(
-    const std::vector<float>& A, 
-    const std::vector<float>& B, 
+inline void FastMatMul::MatrixMultiplyFast(
+    const std::vector<float>& A,
+    const std::vector<float>& B,
     std::vector<float>& C,
     uint32_t n,  // rows in A (and rows in C)
     uint32_t m,  // columns in B (and columns in C)
@@ -129,60 +406,12 @@ void MatrixMultiplyNeon::MatrixMultiplyFast(
         return;
     }
 
-    // Round up dimensions to multiples of 4 for NEON processing
-    const uint32_t n_padded = ((n + 3) / 4) * 4;
-    const uint32_t m_padded = ((m + 3) / 4) * 4;
-    const uint32_t k_padded = ((k + 3) / 4) * 4;
-
-    // If dimensions are already multiples of 4, no need for padding
-    if (n == n_padded && m == m_padded && k == k_padded) {
-        // Initialize C to zeros before computation
-        std::fill(C.begin(), C.end(), 0.0f);
-        MatrixMultiplyNeon::MatrixMultiply(const_cast<float*>(A.data()), const_cast<float*>(B.data()), C.data(), n, m, k);
-        return;
-    }
-
-    // Create padded matrices
-    std::vector<float> A_padded(n_padded * k_padded, 0.0f);
-    std::vector<float> B_padded(k_padded * m_padded, 0.0f);
-
-    // Copy data from A to A_padded (column-major format)
-    for (uint32_t col = 0; col < k; ++col) {
-        for (uint32_t row = 0; row < n; ++row) {
-            A_padded[col * n_padded + row] = A[col * n + row];
-        }
-    }
-
-    // Copy data from B to B_padded (column-major format)
-    for (uint32_t col = 0; col < m; ++col) {
-        for (uint32_t row = 0; row < k; ++row) {
-            B_padded[col * k_padded + row] = B[col * k + row];
-        }
-    }
-
-    std::vector<float> C_padded(n_padded * m_padded, 0.0f);
-
-    //std::clog << "\n";
-    //for(auto it: A_padded) std::clog << it << " ";
-    //std::clog << "\n";
-    //for(auto it: B_padded) std::clog << it << " ";
-    //std::clog << "\n";
-
-    MatrixMultiplyNeon::MatrixMultiply(A_padded.data(), B_padded.data(), C_padded.data(), n_padded, m_padded, k_padded);
-
-    //for(auto it: C_padded) std::clog << it << " ";
-    //std::clog << "\n";
-
-    for (uint32_t col = 0; col < m; ++col) {
-        for (uint32_t row = 0; row < n; ++row) {
-            C[col * n + row] = C_padded[col * n_padded + row];
-        }
-    }
-    //for(auto it: C) std::clog << it << " ";
+    // Column-major operands: unit row stride, leading dimension as column stride
+    Gemm(n, m, k, A.data(), 1, n, B.data(), 1, k, C.data(), n);
 }
 
 
-std::vector<float> MatrixMultiplyNeon::MatrixMultiplyFast(
+inline std::vector<float> FastMatMul::MatrixMultiplyFast(
     const std::vector<float>& A,
     const std::vector<float>& B,
     uint32_t n,  // rows in A (and rows in C)
@@ -190,6 +419,6 @@ std::vector<float> MatrixMultiplyNeon::MatrixMultiplyFast(
     uint32_t k   // columns in A and rows in B
 ) {
     std::vector<float> C(n * m, 0.0f);
-    MatrixMultiplyNeon::MatrixMultiplyFast(A, B, C, n, m, k);
+    FastMatMul::MatrixMultiplyFast(A, B, C, n, m, k);
     return C;
-}
\ No newline at end of file
+}
@@ -0,0 +1,85 @@
+#include "Executor.h"
+
+#pragma once
+
+// Folds MatMul/Conv -> ScalarAdd -> ReLU chains (either tail optional) into the
+// GEMM store epilogue. The fused step runs at the position of the last folded
+// node, so the addend is always computed before it; the intermediate Add/ReLU
+// results are never materialized. A node is only folded into its producer when
+// it is that producer's single consumer, and an Add only when its other operand
+// has the GEMM's output shape, or is a per-channel bias the node fusesBias().
+class EpilogueFusion {
+public:
+    // Returns the number of steps folded away
+    static size_t Apply(Executor& executor) {
+        std::vector<Executor::Step>& steps = executor.schedule();
+        const std::vector<std::vector<size_t>> shapes = executor.inferShapes();
+
+        std::vector<std::vector<size_t>> consumers(steps.size());
+        for (size_t i = 0; i < steps.size(); ++i) {
+            for (size_t input : steps[i].inputs) consumers[input].push_back(i);
+        }
+
+        size_t folded = 0;
+        for (size_t head = 0; head < steps.size(); ++head) {
+            const Executor::Step& gemm = steps[head];
+            if (gemm.skipped || !gemm.node->fusesEpilogue() || gemm.addend || gemm.addend_is_input || gemm.relu) continue;
+
+            Executor::Step fused = gemm;
+            std::vector<size_t> chain = {head};
+
+            // Bias: the other operand becomes the addend
+            size_t tail = head;
+            if (SingleConsumer(steps, consumers, tail, OpKind::Add)) {
+                const size_t add = consumers[tail].front();
+                const auto* binary = dynamic_cast<const BinaryOperation*>(steps[add].node);
+                const bool from_node = steps[add].inputs.size() == 2;
+                const size_t other = !from_node ? 0 : steps[add].inputs[0] == tail ? steps[add].inputs[1] : steps[add].inputs[0];
+                const Tensor* constant = !binary || from_node ? nullptr : binary->lhsTensor() ? binary->lhsTensor() : binary->rhsTensor();
+                const std::vector<size_t>* addend_shape = from_node ? &shapes[other] : constant ? &constant->shape() : nullptr;
+                const bool fits = addend_shape && (*addend_shape == shapes[head] ||
+                                                   (gemm.node->fusesBias() && Epilogue::IsChannelBias(*addend_shape, shapes[head])));
+                if (binary && fits) {
+                    if (from_node) {
+                        fused.inputs.push_back(other);
+                        fused.addend_is_input = true;
+                    } else {
+                        fused.addend = constant;
+                    }
+                    tail = add;
+                    chain.push_back(tail);
+                }
+            }
+
+            if (SingleConsumer(steps, consumers, tail, OpKind::ReLU)) {
+                tail = consumers[tail].front();
+                fused.relu = true;
+                chain.push_back(tail);
+            }
+
+            if (tail == head) continue;
+
+            fused.uses = steps[tail].uses;
+            for (size_t pos : chain) {
+                if (pos == tail) continue;
+                steps[pos].skipped = true;
+                steps[pos].inputs.clear();
+                steps[pos].uses = 0;
+            }
+            steps[tail] = fused;
+            folded += chain.size() - 1;
+        }
+        return folded;
+    }
+
+private:
+    // Whether the result at pos is read once, by a node of the given kind that
+    // takes it as a node operand
+    static bool SingleConsumer(const std::vector<Executor::Step>& steps,
+                               const std::vector<std::vector<size_t>>& consumers,
+                               size_t pos, OpKind kind) {
+        if (steps[pos].uses != 1 || consumers[pos].size() != 1) return false;
+        const Executor::Step& consumer = steps[consumers[pos].front()];
+        return !consumer.skipped && consumer.node->kind() == kind;
+    }
+};
@@ -0,0 +1,26 @@
+#include <cstddef>
+
+#pragma once
+
+// Elementwise work a GEMM applies to C while the last KC block of a tile is
+// still in registers: C = relu(A * B + addend).
+struct GemmEpilogue {
+    const float *addend = nullptr; // element (i, j) at addend[i * rs_addend + j * ld_addend]
+    size_t ld_addend = 0;          // 0: one value per row, broadcast along it
+    size_t rs_addend = 1;          // 1, or 0: one value per column (e.g. a bias per output channel)
+    bool relu = false;
+
+    // Same epilogue for the sub-matrix of C starting at (row, col)
+    GemmEpilogue Offset(size_t row, size_t col) const {
+        GemmEpilogue tile = *this;
+        if (addend) tile.addend = addend + row * rs_addend + col * ld_addend;
+        return tile;
+    }
+
+    // Scalar version, for edge tiles and non-GEMM paths
+    float Apply(float value, size_t row, size_t col) const {
+        if (addend) value += addend[row * rs_addend + col * ld_addend];
+        if (relu && value < 0.0f) value = 0.0f;
+        return value;
+    }
+};
@@ -0,0 +1,78 @@
+#include <cstddef>
+#include "GemmEpilogue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 + FMA 16x6 micro-kernel over packed panels, see BlockedGemm.h.
+// 12 ymm accumulators + 2 for A + 1 broadcast of B fill the 16 registers.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class GemmKernelAvx2 {
+public:
+    static constexpr size_t kMR = 16;
+    static constexpr size_t kNR = 6;
+    static constexpr size_t kMC = 96;
+    static constexpr size_t kKC = 256;
+    static constexpr size_t kNC = 3072;
+
+    __attribute__((target("avx2,fma")))
+    static void MicroKernel(
+        size_t kc,
+        const float *a,
+        const float *b,
+        float *c,
+        size_t ldc,
+        bool accumulate,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        // these are the columns of a 16x6 sub matrix of C, two halves each
+        __m256 acc[kNR][2];
+        for (size_t j = 0; j < kNR; ++j) {
+            acc[j][0] = _mm256_setzero_ps();
+            acc[j][1] = _mm256_setzero_ps();
+        }
+
+        for (size_t p = 0; p < kc; ++p) {
+            const __m256 A0 = _mm256_loadu_ps(a);
+            const __m256 A1 = _mm256_loadu_ps(a + 8);
+            for (size_t j = 0; j < kNR; ++j) {
+                const __m256 Bj = _mm256_broadcast_ss(b + j);
+                acc[j][0] = _mm256_fmadd_ps(A0, Bj, acc[j][0]);
+                acc[j][1] = _mm256_fmadd_ps(A1, Bj, acc[j][1]);
+            }
+            a += kMR;
+            b += kNR;
+        }
+
+        for (size_t j = 0; j < kNR; ++j) {
+            float *c_col = c + j * ldc;
+            if (accumulate) {
+                acc[j][0] = _mm256_add_ps(acc[j][0], _mm256_loadu_ps(c_col));
+                acc[j][1] = _mm256_add_ps(acc[j][1], _mm256_loadu_ps(c_col + 8));
+            }
+            if (epilogue && epilogue->addend) {
+                const float *d_col = epilogue->addend + j * epilogue->ld_addend;
+                if (epilogue->rs_addend == 0) {
+                    acc[j][0] = _mm256_add_ps(acc[j][0], _mm256_set1_ps(*d_col));
+                    acc[j][1] = _mm256_add_ps(acc[j][1], _mm256_set1_ps(*d_col));
+                } else {
+                    acc[j][0] = _mm256_add_ps(acc[j][0], _mm256_loadu_ps(d_col));
+                    acc[j][1] = _mm256_add_ps(acc[j][1], _mm256_loadu_ps(d_col + 8));
+                }
+            }
+            if (epilogue && epilogue->relu) {
+                acc[j][0] = _mm256_max_ps(acc[j][0], _mm256_setzero_ps());
+                acc[j][1] = _mm256_max_ps(acc[j][1], _mm256_setzero_ps());
+            }
+            _mm256_storeu_ps(c_col, acc[j][0]);
+            _mm256_storeu_ps(c_col + 8, acc[j][1]);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include <cstddef>
+#include "GemmEpilogue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX-512F 32x12 micro-kernel over packed panels, see BlockedGemm.h.
+// 24 zmm accumulators + 2 for A + 1 broadcast of B out of 32 registers.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class GemmKernelAvx512 {
+public:
+    static constexpr size_t kMR = 32;
+    static constexpr size_t kNR = 12;
+    static constexpr size_t kMC = 192;
+    static constexpr size_t kKC = 384;
+    static constexpr size_t kNC = 3072;
+
+    __attribute__((target("avx512f")))
+    static void MicroKernel(
+        size_t kc,
+        const float *a,
+        const float *b,
+        float *c,
+        size_t ldc,
+        bool accumulate,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        // these are the columns of a 32x12 sub matrix of C, two halves each
+        __m512 acc[kNR][2];
+        for (size_t j = 0; j < kNR; ++j) {
+            acc[j][0] = _mm512_setzero_ps();
+            acc[j][1] = _mm512_setzero_ps();
+        }
+
+        for (size_t p = 0; p < kc; ++p) {
+            const __m512 A0 = _mm512_loadu_ps(a);
+            const __m512 A1 = _mm512_loadu_ps(a + 16);
+            for (size_t j = 0; j < kNR; ++j) {
+                const __m512 Bj = _mm512_set1_ps(b[j]);
+                acc[j][0] = _mm512_fmadd_ps(A0, Bj, acc[j][0]);
+                acc[j][1] = _mm512_fmadd_ps(A1, Bj, acc[j][1]);
+            }
+            a += kMR;
+            b += kNR;
+        }
+
+        for (size_t j = 0; j < kNR; ++j) {
+            float *c_col = c + j * ldc;
+            if (accumulate) {
+                acc[j][0] = _mm512_add_ps(acc[j][0], _mm512_loadu_ps(c_col));
+                acc[j][1] = _mm512_add_ps(acc[j][1], _mm512_loadu_ps(c_col + 16));
+            }
+            if (epilogue && epilogue->addend) {
+                const float *d_col = epilogue->addend + j * epilogue->ld_addend;
+                if (epilogue->rs_addend == 0) {
+                    acc[j][0] = _mm512_add_ps(acc[j][0], _mm512_set1_ps(*d_col));
+                    acc[j][1] = _mm512_add_ps(acc[j][1], _mm512_set1_ps(*d_col));
+                } else {
+                    acc[j][0] = _mm512_add_ps(acc[j][0], _mm512_loadu_ps(d_col));
+                    acc[j][1] = _mm512_add_ps(acc[j][1], _mm512_loadu_ps(d_col + 16));
+                }
+            }
+            if (epilogue && epilogue->relu) {
+                acc[j][0] = _mm512_max_ps(acc[j][0], _mm512_setzero_ps());
+                acc[j][1] = _mm512_max_ps(acc[j][1], _mm512_setzero_ps());
+            }
+            _mm512_storeu_ps(c_col, acc[j][0]);
+            _mm512_storeu_ps(c_col + 16, acc[j][1]);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include <cstddef>
+#include "GemmEpilogue.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#pragma once
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+// NEON 8x12 micro-kernel over packed panels, see BlockedGemm.h.
+// 24 q-register accumulators + 2 for A + 3 for B out of 32 registers.
+class GemmKernelNeon {
+public:
+    static constexpr size_t kMR = 8;
+    static constexpr size_t kNR = 12;
+    static constexpr size_t kMC = 128;
+    static constexpr size_t kKC = 256;
+    static constexpr size_t kNC = 3072;
+
+    static void MicroKernel(
+        size_t kc,
+        const float32_t *a,
+        const float32_t *b,
+        float32_t *c,
+        size_t ldc,
+        bool accumulate,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        // these are the columns of a 8x12 sub matrix of C, two halves each
+        float32x4_t C0_lo = vmovq_n_f32(0), C0_hi = vmovq_n_f32(0);
+        float32x4_t C1_lo = vmovq_n_f32(0), C1_hi = vmovq_n_f32(0);
+        float32x4_t C2_lo = vmovq_n_f32(0), C2_hi = vmovq_n_f32(0);
+        float32x4_t C3_lo = vmovq_n_f32(0), C3_hi = vmovq_n_f32(0);
+        float32x4_t C4_lo = vmovq_n_f32(0), C4_hi = vmovq_n_f32(0);
+        float32x4_t C5_lo = vmovq_n_f32(0), C5_hi = vmovq_n_f32(0);
+        float32x4_t C6_lo = vmovq_n_f32(0), C6_hi = vmovq_n_f32(0);
+        float32x4_t C7_lo = vmovq_n_f32(0), C7_hi = vmovq_n_f32(0);
+        float32x4_t C8_lo = vmovq_n_f32(0), C8_hi = vmovq_n_f32(0);
+        float32x4_t C9_lo = vmovq_n_f32(0), C9_hi = vmovq_n_f32(0);
+        float32x4_t C10_lo = vmovq_n_f32(0), C10_hi = vmovq_n_f32(0);
+        float32x4_t C11_lo = vmovq_n_f32(0), C11_hi = vmovq_n_f32(0);
+
+        for (size_t p = 0; p < kc; ++p) {
+            // Column segment of A and one row of B, then multiply accumulate by lane
+            const float32x4_t A0 = vld1q_f32(a);
+            const float32x4_t A1 = vld1q_f32(a + 4);
+            const float32x4_t B0 = vld1q_f32(b);
+            const float32x4_t B1 = vld1q_f32(b + 4);
+            const float32x4_t B2 = vld1q_f32(b + 8);
+
+            C0_lo = vfmaq_laneq_f32(C0_lo, A0, B0, 0);
+            C0_hi = vfmaq_laneq_f32(C0_hi, A1, B0, 0);
+            C1_lo = vfmaq_laneq_f32(C1_lo, A0, B0, 1);
+            C1_hi = vfmaq_laneq_f32(C1_hi, A1, B0, 1);
+            C2_lo = vfmaq_laneq_f32(C2_lo, A0, B0, 2);
+            C2_hi = vfmaq_laneq_f32(C2_hi, A1, B0, 2);
+            C3_lo = vfmaq_laneq_f32(C3_lo, A0, B0, 3);
+            C3_hi = vfmaq_laneq_f32(C3_hi, A1, B0, 3);
+            C4_lo = vfmaq_laneq_f32(C4_lo, A0, B1, 0);
+            C4_hi = vfmaq_laneq_f32(C4_hi, A1, B1, 0);
+            C5_lo = vfmaq_laneq_f32(C5_lo, A0, B1, 1);
+            C5_hi = vfmaq_laneq_f32(C5_hi, A1, B1, 1);
+            C6_lo = vfmaq_laneq_f32(C6_lo, A0, B1, 2);
+            C6_hi = vfmaq_laneq_f32(C6_hi, A1, B1, 2);
+            C7_lo = vfmaq_laneq_f32(C7_lo, A0, B1, 3);
+            C7_hi = vfmaq_laneq_f32(C7_hi, A1, B1, 3);
+            C8_lo = vfmaq_laneq_f32(C8_lo, A0, B2, 0);
+            C8_hi = vfmaq_laneq_f32(C8_hi, A1, B2, 0);
+            C9_lo = vfmaq_laneq_f32(C9_lo, A0, B2, 1);
+            C9_hi = vfmaq_laneq_f32(C9_hi, A1, B2, 1);
+            C10_lo = vfmaq_laneq_f32(C10_lo, A0, B2, 2);
+            C10_hi = vfmaq_laneq_f32(C10_hi, A1, B2, 2);
+            C11_lo = vfmaq_laneq_f32(C11_lo, A0, B2, 3);
+            C11_hi = vfmaq_laneq_f32(C11_hi, A1, B2, 3);
+
+            a += kMR;
+            b += kNR;
+        }
+
+        Store(c + 0 * ldc, C0_lo, C0_hi, accumulate, epilogue, 0);
+        Store(c + 1 * ldc, C1_lo, C1_hi, accumulate, epilogue, 1);
+        Store(c + 2 * ldc, C2_lo, C2_hi, accumulate, epilogue, 2);
+        Store(c + 3 * ldc, C3_lo, C3_hi, accumulate, epilogue, 3);
+        Store(c + 4 * ldc, C4_lo, C4_hi, accumulate, epilogue, 4);
+        Store(c + 5 * ldc, C5_lo, C5_hi, accumulate, epilogue, 5);
+        Store(c + 6 * ldc, C6_lo, C6_hi, accumulate, epilogue, 6);
+        Store(c + 7 * ldc, C7_lo, C7_hi, accumulate, epilogue, 7);
+        Store(c + 8 * ldc, C8_lo, C8_hi, accumulate, epilogue, 8);
+        Store(c + 9 * ldc, C9_lo, C9_hi, accumulate, epilogue, 9);
+        Store(c + 10 * ldc, C10_lo, C10_hi, accumulate, epilogue, 10);
+        Store(c + 11 * ldc, C11_lo, C11_hi, accumulate, epilogue, 11);
+    }
+
+private:
+    static void Store(float32_t *c, float32x4_t lo, float32x4_t hi, bool accumulate,
+                      const GemmEpilogue *epilogue, size_t col) {
+        if (accumulate) {
+            lo = vaddq_f32(lo, vld1q_f32(c));
+            hi = vaddq_f32(hi, vld1q_f32(c + 4));
+        }
+        if (epilogue && epilogue->addend) {
+            const float32_t *d = epilogue->addend + col * epilogue->ld_addend;
+            const bool bias = epilogue->rs_addend == 0;
+            lo = vaddq_f32(lo, bias ? vdupq_n_f32(*d) : vld1q_f32(d));
+            hi = vaddq_f32(hi, bias ? vdupq_n_f32(*d) : vld1q_f32(d + 4));
+        }
+        if (epilogue && epilogue->relu) {
+            lo = vmaxq_f32(lo, vmovq_n_f32(0));
+            hi = vmaxq_f32(hi, vmovq_n_f32(0));
+        }
+        vst1q_f32(c, lo);
+        vst1q_f32(c + 4, hi);
+    }
+};
+
+#endif
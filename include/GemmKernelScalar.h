@@ -0,0 +1,42 @@
+#include <cstddef>
+#include "GemmEpilogue.h"
+
+#pragma once
+
+// Portable fallback used when no SIMD backend is available.
+// 4x4 micro-kernel over packed panels, see BlockedGemm.h.
+class GemmKernelScalar {
+public:
+    static constexpr size_t kMR = 4;
+    static constexpr size_t kNR = 4;
+    static constexpr size_t kMC = 64;
+    static constexpr size_t kKC = 256;
+    static constexpr size_t kNC = 1024;
+
+    static void MicroKernel(
+        size_t kc,
+        const float *a,
+        const float *b,
+        float *c,
+        size_t ldc,
+        bool accumulate,
+        const GemmEpilogue *epilogue = nullptr
+    ) {
+        float acc[kNR][kMR] = {};
+        for (size_t p = 0; p < kc; ++p) {
+            for (size_t j = 0; j < kNR; ++j) {
+                for (size_t i = 0; i < kMR; ++i) {
+                    acc[j][i] += a[i] * b[j];
+                }
+            }
+            a += kMR;
+            b += kNR;
+        }
+        for (size_t j = 0; j < kNR; ++j) {
+            for (size_t i = 0; i < kMR; ++i) {
+                float value = accumulate ? c[i + j * ldc] + acc[j][i] : acc[j][i];
+                c[i + j * ldc] = epilogue ? epilogue->Apply(value, i, j) : value;
+            }
+        }
+    }
+};
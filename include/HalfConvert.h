@@ -0,0 +1,32 @@
+#include "DType.h"
+#include "CpuFeatures.h"
+#include "HalfConvertKernelScalar.h"
+#include "HalfConvertKernelF16c.h"
+#include "HalfConvertKernelAvx512.h"
+
+#pragma once
+
+// Bulk bf16/fp16 <-> float conversion for 16-bit tensors and the GEMM
+// packing that widens them, on the widest ISA the host has. Rounds to
+// nearest even; see HalfConvertKernelAvx512 for bf16 denormals.
+class HalfConvert {
+public:
+    static void ToFloat(DType dtype, const uint16_t *in, float *out, size_t n) {
+#if defined(__x86_64__) || defined(__i386__)
+        const CpuFeatures &cpu = CpuFeatures::Get();
+        if (cpu.avx512f) return HalfConvertKernelAvx512::ToFloat(dtype, in, out, n);
+        if (cpu.avx2 && cpu.f16c) return HalfConvertKernelF16c::ToFloat(dtype, in, out, n);
+#endif
+        HalfConvertKernelScalar::ToFloat(dtype, in, out, n);
+    }
+
+    static void FromFloat(DType dtype, const float *in, uint16_t *out, size_t n) {
+#if defined(__x86_64__) || defined(__i386__)
+        const CpuFeatures &cpu = CpuFeatures::Get();
+        if (cpu.avx512bf16 && dtype == DType::BF16) return HalfConvertKernelAvx512::FromFloatBf16(in, out, n);
+        if (cpu.avx512f) return HalfConvertKernelAvx512::FromFloat(dtype, in, out, n);
+        if (cpu.avx2 && cpu.f16c) return HalfConvertKernelF16c::FromFloat(dtype, in, out, n);
+#endif
+        HalfConvertKernelScalar::FromFloat(dtype, in, out, n);
+    }
+};
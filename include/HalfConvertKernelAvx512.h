@@ -0,0 +1,65 @@
+#include "DType.h"
+#include "HalfConvertKernelScalar.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX-512 conversion kernels, 16 values per step with a scalar tail.
+// FromFloatBf16 uses vcvtneps2bf16 (AVX512-BF16) for CPUs that have it; it
+// treats denormal inputs as zero, unlike the integer rounding used otherwise.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class HalfConvertKernelAvx512 {
+public:
+    __attribute__((target("avx512f")))
+    static void ToFloat(DType dtype, const uint16_t *in, float *out, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+            const __m512 f = dtype == DType::BF16
+                ? _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16))
+                : _mm512_cvtph_ps(h);
+            _mm512_storeu_ps(out + i, f);
+        }
+        HalfConvertKernelScalar::ToFloat(dtype, in + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    static void FromFloat(DType dtype, const float *in, uint16_t *out, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m512 f = _mm512_loadu_ps(in + i);
+            const __m256i h = dtype == DType::BF16 ? Bf16(f) : _mm512_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), h);
+        }
+        HalfConvertKernelScalar::FromFloat(dtype, in + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx512f,avx512bf16")))
+    static void FromFloatBf16(const float *in, uint16_t *out, size_t n) {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m256bh h = _mm512_cvtneps_pbh(_mm512_loadu_ps(in + i));
+            std::memcpy(out + i, &h, sizeof(h));
+        }
+        HalfConvertKernelScalar::FromFloat(DType::BF16, in + i, out + i, n - i);
+    }
+
+private:
+    // half::FloatToBf16 on 16 lanes
+    __attribute__((target("avx512f")))
+    static __m256i Bf16(__m512 f) {
+        const __m512i bits = _mm512_castps_si512(f);
+        const __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(1));
+        const __m512i rounded = _mm512_srli_epi32(_mm512_add_epi32(bits, _mm512_add_epi32(lsb, _mm512_set1_epi32(0x7fff))), 16);
+        const __m512i quiet = _mm512_or_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(0x40));
+        const __mmask16 nan = _mm512_cmp_ps_mask(f, f, _CMP_UNORD_Q);
+        return _mm512_cvtepi32_epi16(_mm512_mask_mov_epi32(rounded, nan, quiet));
+    }
+};
+
+#endif
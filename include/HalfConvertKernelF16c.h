@@ -0,0 +1,56 @@
+#include "DType.h"
+#include "HalfConvertKernelScalar.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 conversion kernels: F16C's vcvtph2ps/vcvtps2ph for fp16, integer
+// shifts and rounding for bf16, 8 values per step with a scalar tail.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class HalfConvertKernelF16c {
+public:
+    __attribute__((target("avx2,f16c")))
+    static void ToFloat(DType dtype, const uint16_t *in, float *out, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            const __m256 f = dtype == DType::BF16
+                ? _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16))
+                : _mm256_cvtph_ps(h);
+            _mm256_storeu_ps(out + i, f);
+        }
+        HalfConvertKernelScalar::ToFloat(dtype, in + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx2,f16c")))
+    static void FromFloat(DType dtype, const float *in, uint16_t *out, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m256 f = _mm256_loadu_ps(in + i);
+            const __m128i h = dtype == DType::BF16 ? Bf16(f) : _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), h);
+        }
+        HalfConvertKernelScalar::FromFloat(dtype, in + i, out + i, n - i);
+    }
+
+private:
+    // half::FloatToBf16 on 8 lanes
+    __attribute__((target("avx2")))
+    static __m128i Bf16(__m256 f) {
+        const __m256i bits = _mm256_castps_si256(f);
+        const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+        const __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff))), 16);
+        const __m256i quiet = _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x40));
+        const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(f, f, _CMP_UNORD_Q));
+        const __m256i result = _mm256_blendv_epi8(rounded, quiet, nan);
+        // 32 -> 16 bits: packus saturates, but every lane is below 0x10000
+        return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(result, result), 0x08));
+    }
+};
+
+#endif
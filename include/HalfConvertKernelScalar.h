@@ -0,0 +1,17 @@
+#include "DType.h"
+
+#pragma once
+
+// Portable 16-bit <-> float conversion kernels, see HalfConvert.h
+class HalfConvertKernelScalar {
+public:
+    static void ToFloat(DType dtype, const uint16_t *in, float *out, size_t n) {
+        if (dtype == DType::BF16) for (size_t i = 0; i < n; ++i) out[i] = half::Bf16ToFloat(in[i]);
+        else for (size_t i = 0; i < n; ++i) out[i] = half::F16ToFloat(in[i]);
+    }
+
+    static void FromFloat(DType dtype, const float *in, uint16_t *out, size_t n) {
+        if (dtype == DType::BF16) for (size_t i = 0; i < n; ++i) out[i] = half::FloatToBf16(in[i]);
+        else for (size_t i = 0; i < n; ++i) out[i] = half::FloatToF16(in[i]);
+    }
+};
@@ -0,0 +1,22 @@
+#include <cstddef>
+#include <cstdint>
+
+#pragma once
+
+// Dequantizing store of an int8 GEMM, see Int8Gemm.h. Row r of the int32
+// result becomes C[r][j] = relu(scales[r] * (acc - offsets[r]) + addend[r][j]).
+struct Int8Epilogue {
+    const float *scales = nullptr;    // per row: weight scale * activation scale
+    const int32_t *offsets = nullptr; // per row: activation zero point times the row's weight sum
+    const float *addend = nullptr;    // element (r, j) at addend[r * ld_addend + j * cs_addend]
+    size_t ld_addend = 0;
+    size_t cs_addend = 1;             // 1, or 0: one value per row (e.g. a bias per output channel)
+    bool relu = false;
+
+    float Apply(int32_t acc, size_t row, size_t col) const {
+        float value = scales[row] * static_cast<float>(acc - offsets[row]);
+        if (addend) value += addend[row * ld_addend + col * cs_addend];
+        if (relu && value < 0.0f) value = 0.0f;
+        return value;
+    }
+};
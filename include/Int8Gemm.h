@@ -0,0 +1,163 @@
+#include "FastMatMul.h"
+#include "CpuFeatures.h"
+#include "ThreadPool.h"
+#include "QuantizedTensor.h"
+#include "Int8Epilogue.h"
+#include "Int8GemmKernelScalar.h"
+#include "Int8GemmKernelAvxVnni.h"
+#include "Int8GemmKernelAvx512Vnni.h"
+#include <cmath>
+#include <cstring>
+
+#pragma once
+
+// Int8 GEMM C(rows x n) = W(rows x depth) * X(depth x n) with per-row symmetric
+// int8 weights and asymmetric activations, accumulated in int32.
+//
+// VNNI multiplies unsigned by signed bytes, so activations are packed as
+// uint8 q + 128 and the extra 128 + zero_point times each weight row's sum is
+// subtracted in the store (Int8Epilogue::offsets). Activations are quantized
+// while they are packed and results dequantized while they are stored, so
+// callers pass and get fp32 like FastMatMul.
+class Int8Gemm {
+public:
+    // Weights quantized once, rows and depth padded to the micro-kernel tile
+    // with zeros so kernels never test bounds
+    struct Weights {
+        size_t rows = 0, depth = 0;
+        size_t depth4 = 0;                   // depth rounded up to 4, row stride of data
+        std::vector<int8_t> data;            // RoundUp(rows, kRows) x depth4, row-major
+        std::vector<float> scales;           // per row
+        std::vector<int32_t> row_sums;       // per row, of the int8 values
+    };
+
+    // Row r of W at w[r * rsw + p * csw], one symmetric scale per row
+    static Weights QuantizeWeights(size_t rows, size_t depth, const float* w, size_t rsw, size_t csw) {
+        Weights weights;
+        weights.rows = rows;
+        weights.depth = depth;
+        weights.depth4 = RoundUp(depth, 4);
+        weights.data.assign(RoundUp(rows, kRows) * weights.depth4, 0);
+        weights.scales.resize(rows);
+        weights.row_sums.resize(rows);
+        for (size_t r = 0; r < rows; ++r) {
+            float max_abs = 0.0f;
+            for (size_t p = 0; p < depth; ++p) max_abs = std::max(max_abs, std::fabs(w[r * rsw + p * csw]));
+            const QuantParams params = QuantParams::Symmetric(max_abs);
+            int32_t sum = 0;
+            for (size_t p = 0; p < depth; ++p) {
+                const int8_t q = params.Quantize(w[r * rsw + p * csw]);
+                weights.data[r * weights.depth4 + p] = q;
+                sum += q;
+            }
+            weights.scales[r] = params.scale;
+            weights.row_sums[r] = sum;
+        }
+        return weights;
+    }
+
+    // Column j of X at x[p * ldx + j], quantized with activation; C row-major
+    // with leading dimension ldc. addend, if any, is shaped and strided like C,
+    // or with per_row holds one value per row, ld_addend apart.
+    static void Run(const Weights& w, const float* x, size_t ldx, size_t n, const QuantParams& activation,
+                    float* c, size_t ldc, const float* addend = nullptr, size_t ld_addend = 0, bool relu = false,
+                    bool per_row = false) {
+        if (w.rows == 0 || n == 0) return;
+        std::vector<float> scales(w.rows);
+        std::vector<int32_t> offsets(w.rows);
+        for (size_t r = 0; r < w.rows; ++r) {
+            scales[r] = w.scales[r] * activation.scale;
+            offsets[r] = (activation.zero_point + 128) * w.row_sums[r];
+        }
+        Int8Epilogue epilogue{scales.data(), offsets.data(), addend, ld_addend, per_row ? size_t(0) : size_t(1), relu};
+        VisitKernel([&](auto kernel) { RunWith<decltype(kernel)>(w, x, ldx, n, activation, c, ldc, epilogue); });
+    }
+
+private:
+    static constexpr size_t kRows = 4;   // weight rows per micro-kernel, the same for every kernel
+    static constexpr size_t kPanels = 4; // activation panels per micro-kernel
+    static constexpr size_t kBlockColumns = 512; // columns packed at once, a multiple of every kPanels * kLanes
+
+    static size_t RoundUp(size_t value, size_t multiple) { return (value + multiple - 1) / multiple * multiple; }
+
+    // VNNI kernel of the active backend's width, so forcing a backend also picks
+    // the int8 kernel; without VNNI the portable kernel runs
+    template <typename Visitor>
+    static void VisitKernel(Visitor&& visit) {
+#if defined(__x86_64__) || defined(__i386__)
+        const CpuFeatures& cpu = CpuFeatures::Get();
+        switch (FastMatMul::GetBackend()) {
+            case GemmBackend::Avx512:
+                if (cpu.avx512vnni) return visit(Int8GemmKernelAvx512Vnni());
+                [[fallthrough]];
+            case GemmBackend::Avx2:
+                if (cpu.avxvnni) return visit(Int8GemmKernelAvxVnni());
+                break;
+            default:
+                break;
+        }
+#endif
+        visit(Int8GemmKernelScalar());
+    }
+
+    // Columns of X in blocks of kBlockColumns, each packed once and swept by
+    // kRows x kPanels micro-tiles. Long blocks keep the packing reads of each
+    // depth row sequential; short ones leave most of X's rows cache-missing.
+    template <typename Kernel>
+    static void RunWith(const Weights& w, const float* x, size_t ldx, size_t n, const QuantParams& activation,
+                        float* c, size_t ldc, const Int8Epilogue& epilogue) {
+        static_assert(Kernel::kRows == kRows);
+        constexpr size_t L = Kernel::kLanes;
+        const size_t k4 = w.depth4 / 4;
+        const size_t panel_bytes = k4 * L * 4;
+        const size_t tile = kPanels * L;
+        const size_t tasks = (n + kBlockColumns - 1) / kBlockColumns;
+        ThreadPool::Shared().ParallelFor(tasks, [&](size_t task) {
+            const size_t block0 = task * kBlockColumns;
+            const size_t block = std::min(kBlockColumns, n - block0);
+            thread_local std::vector<uint8_t> packed;
+            packed.resize(kBlockColumns / L * panel_bytes);
+            PackActivations<Kernel>(x, ldx, w.depth, block0, block, activation, packed.data(), panel_bytes);
+            for (size_t j = 0; j < block; j += tile) {
+                const size_t cols = std::min(tile, block - j);
+                const uint8_t* panels = packed.data() + j / L * panel_bytes;
+                for (size_t row0 = 0; row0 < w.rows; row0 += kRows) {
+                    const size_t rows = std::min(kRows, w.rows - row0);
+                    const int8_t* weights = w.data.data() + row0 * w.depth4;
+                    switch ((cols + L - 1) / L) {
+                        case 1: Kernel::template MicroKernel<1>(k4, weights, w.depth4, panels, panel_bytes, c, ldc, row0, block0 + j, rows, cols, epilogue); break;
+                        case 2: Kernel::template MicroKernel<2>(k4, weights, w.depth4, panels, panel_bytes, c, ldc, row0, block0 + j, rows, cols, epilogue); break;
+                        case 3: Kernel::template MicroKernel<3>(k4, weights, w.depth4, panels, panel_bytes, c, ldc, row0, block0 + j, rows, cols, epilogue); break;
+                        default: Kernel::template MicroKernel<4>(k4, weights, w.depth4, panels, panel_bytes, c, ldc, row0, block0 + j, rows, cols, epilogue); break;
+                    }
+                }
+            }
+        }, FastMatMul::GetNumThreads());
+    }
+
+    // Panel p holds columns col0 + p * L ... as [k4][L][4]: the 4 consecutive
+    // depths of a column share one int32 lane, as vpdpbusd expects. Whole
+    // 4 x L groups go through the kernel's vector PackQuad; depth and columns
+    // past the matrix are zero.
+    template <typename Kernel>
+    static void PackActivations(const float* x, size_t ldx, size_t depth, size_t col0, size_t cols,
+                                const QuantParams& activation, uint8_t* packed, size_t panel_bytes) {
+        constexpr size_t L = Kernel::kLanes;
+        const float inv_scale = 1.0f / activation.scale;
+        const float shift = static_cast<float>(activation.zero_point + 128);
+        for (size_t p = 0; p < depth; p += 4) {
+            const size_t quad = std::min<size_t>(4, depth - p);
+            uint8_t* out = packed + p * L;
+            for (size_t j = 0; j < cols; j += L, out += panel_bytes) {
+                const float* in = x + p * ldx + col0 + j;
+                if (quad == 4 && j + L <= cols) {
+                    Kernel::PackQuad(in, ldx, inv_scale, shift, out);
+                    continue;
+                }
+                for (size_t l = 0; l < L; ++l)
+                    for (size_t t = 0; t < 4; ++t)
+                        out[l * 4 + t] = t < quad && j + l < cols ? Int8GemmKernelScalar::Quantize(in[t * ldx + l], inv_scale, shift) : 0;
+            }
+        }
+    }
+};
@@ -0,0 +1,86 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Int8Epilogue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX512-VNNI int8 micro-kernel, see Int8Gemm.h. vpdpbusd multiplies 4 uint8
+// activations by 4 int8 weights and adds the sums to an int32 lane, so one
+// instruction does 64 multiply-adds. 4 rows x 4 panels = 16 zmm accumulators.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class Int8GemmKernelAvx512Vnni {
+public:
+    static constexpr size_t kRows = 4;
+    static constexpr size_t kLanes = 16;
+
+    // Int8GemmKernelScalar::PackQuad: each row rounded and clamped to [0, 255],
+    // then the 4 rows merged into one byte each of an int32 lane
+    __attribute__((target("avx512f")))
+    static void PackQuad(const float *x, size_t ldx, float inv_scale, float shift, uint8_t *out) {
+        const __m512 scale = _mm512_set1_ps(inv_scale);
+        const __m512 offset = _mm512_set1_ps(shift);
+        const __m512i quad = _mm512_or_si512(
+            _mm512_or_si512(Quantize(x, scale, offset), _mm512_slli_epi32(Quantize(x + ldx, scale, offset), 8)),
+            _mm512_or_si512(_mm512_slli_epi32(Quantize(x + 2 * ldx, scale, offset), 16),
+                           _mm512_slli_epi32(Quantize(x + 3 * ldx, scale, offset), 24)));
+        _mm512_storeu_si512(out, quad);
+    }
+
+    template <size_t P>
+    __attribute__((target("avx512f,avx512bw,avx512vnni")))
+    static void MicroKernel(
+        size_t k4, const int8_t *w, size_t ldw, const uint8_t *b, size_t panel_bytes,
+        float *c, size_t ldc, size_t row0, size_t col0, size_t rows, size_t cols,
+        const Int8Epilogue &epilogue
+    ) {
+        __m512i acc[kRows][P];
+        for (size_t r = 0; r < kRows; ++r)
+            for (size_t p = 0; p < P; ++p) acc[r][p] = _mm512_setzero_si512();
+
+        for (size_t q = 0; q < k4; ++q) {
+            __m512i panel[P];
+            for (size_t p = 0; p < P; ++p) panel[p] = _mm512_loadu_si512(b + p * panel_bytes + q * kLanes * 4);
+            for (size_t r = 0; r < kRows; ++r) {
+                int32_t quad;
+                std::memcpy(&quad, w + r * ldw + q * 4, sizeof(quad));
+                const __m512i a = _mm512_set1_epi32(quad);
+                for (size_t p = 0; p < P; ++p) acc[r][p] = _mm512_dpbusd_epi32(acc[r][p], panel[p], a);
+            }
+        }
+
+        const __m512 zero = _mm512_setzero_ps();
+        for (size_t r = 0; r < rows; ++r) {
+            const size_t row = row0 + r;
+            const __m512 scale = _mm512_set1_ps(epilogue.scales[row]);
+            const __m512i offset = _mm512_set1_epi32(epilogue.offsets[row]);
+            for (size_t p = 0; p < P && p * kLanes < cols; ++p) {
+                const size_t col = col0 + p * kLanes;
+                const size_t count = cols - p * kLanes;
+                const __mmask16 mask = count >= kLanes ? __mmask16(0xffff) : static_cast<__mmask16>((1u << count) - 1);
+                __m512 value = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(acc[r][p], offset)), scale);
+                if (epilogue.addend) {
+                    const float *d = epilogue.addend + row * epilogue.ld_addend;
+                    value = _mm512_add_ps(value, epilogue.cs_addend == 0 ? _mm512_set1_ps(*d) : _mm512_maskz_loadu_ps(mask, d + col));
+                }
+                if (epilogue.relu) value = _mm512_max_ps(value, zero);
+                _mm512_mask_storeu_ps(c + row * ldc + col, mask, value);
+            }
+        }
+    }
+
+private:
+    __attribute__((target("avx512f")))
+    static __m512i Quantize(const float *x, __m512 scale, __m512 offset) {
+        const __m512 q = _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(x), scale), offset);
+        return _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(q, _mm512_setzero_ps()), _mm512_set1_ps(255.0f)));
+    }
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Int8Epilogue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX-VNNI int8 micro-kernel, the ymm counterpart of Int8GemmKernelAvx512Vnni
+// for CPUs with VNNI but without AVX-512. 4 rows x 4 panels = 12 of the 16 ymm
+// registers as accumulators.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class Int8GemmKernelAvxVnni {
+public:
+    static constexpr size_t kRows = 4;
+    static constexpr size_t kLanes = 8;
+
+    // Int8GemmKernelScalar::PackQuad: each row rounded and clamped to [0, 255],
+    // then the 4 rows merged into one byte each of an int32 lane
+    __attribute__((target("avx2")))
+    static void PackQuad(const float *x, size_t ldx, float inv_scale, float shift, uint8_t *out) {
+        const __m256 scale = _mm256_set1_ps(inv_scale);
+        const __m256 offset = _mm256_set1_ps(shift);
+        const __m256i quad = _mm256_or_si256(
+            _mm256_or_si256(Quantize(x, scale, offset), _mm256_slli_epi32(Quantize(x + ldx, scale, offset), 8)),
+            _mm256_or_si256(_mm256_slli_epi32(Quantize(x + 2 * ldx, scale, offset), 16),
+                           _mm256_slli_epi32(Quantize(x + 3 * ldx, scale, offset), 24)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), quad);
+    }
+
+    template <size_t P>
+    __attribute__((target("avx2,avxvnni")))
+    static void MicroKernel(
+        size_t k4, const int8_t *w, size_t ldw, const uint8_t *b, size_t panel_bytes,
+        float *c, size_t ldc, size_t row0, size_t col0, size_t rows, size_t cols,
+        const Int8Epilogue &epilogue
+    ) {
+        __m256i acc[kRows][P];
+        for (size_t r = 0; r < kRows; ++r)
+            for (size_t p = 0; p < P; ++p) acc[r][p] = _mm256_setzero_si256();
+
+        for (size_t q = 0; q < k4; ++q) {
+            __m256i panel[P];
+            for (size_t p = 0; p < P; ++p)
+                panel[p] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + p * panel_bytes + q * kLanes * 4));
+            for (size_t r = 0; r < kRows; ++r) {
+                int32_t quad;
+                std::memcpy(&quad, w + r * ldw + q * 4, sizeof(quad));
+                const __m256i a = _mm256_set1_epi32(quad);
+                for (size_t p = 0; p < P; ++p) acc[r][p] = _mm256_dpbusd_avx_epi32(acc[r][p], panel[p], a);
+            }
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for (size_t r = 0; r < rows; ++r) {
+            const size_t row = row0 + r;
+            const __m256 scale = _mm256_set1_ps(epilogue.scales[row]);
+            const __m256i offset = _mm256_set1_epi32(epilogue.offsets[row]);
+            for (size_t p = 0; p < P && p * kLanes < cols; ++p) {
+                const size_t col = col0 + p * kLanes;
+                const int count = static_cast<int>(std::min(cols - p * kLanes, kLanes));
+                const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count), lanes);
+                __m256 value = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(acc[r][p], offset)), scale);
+                if (epilogue.addend) {
+                    const float *d = epilogue.addend + row * epilogue.ld_addend;
+                    value = _mm256_add_ps(value, epilogue.cs_addend == 0 ? _mm256_set1_ps(*d) : _mm256_maskload_ps(d + col, mask));
+                }
+                if (epilogue.relu) value = _mm256_max_ps(value, zero);
+                _mm256_maskstore_ps(c + row * ldc + col, mask, value);
+            }
+        }
+    }
+
+private:
+    __attribute__((target("avx2")))
+    static __m256i Quantize(const float *x, __m256 scale, __m256 offset) {
+        const __m256 q = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(x), scale), offset);
+        return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(q, _mm256_setzero_ps()), _mm256_set1_ps(255.0f)));
+    }
+};
+
+#endif
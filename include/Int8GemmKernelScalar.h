@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include "Int8Epilogue.h"
+
+#pragma once
+
+// Portable int8 micro-kernel, see Int8Gemm.h: kRows weight rows times P
+// activation panels of kLanes columns, int32 accumulation.
+class Int8GemmKernelScalar {
+public:
+    static constexpr size_t kRows = 4;
+    static constexpr size_t kLanes = 16;
+
+    // Activation x as the uint8 x * inv_scale + shift, shift including the +128
+    // that makes int8 unsigned. Rounds to nearest even like the vector kernels.
+    static uint8_t Quantize(float x, float inv_scale, float shift) {
+        return static_cast<uint8_t>(std::clamp(std::nearbyint(x * inv_scale + shift), 0.0f, 255.0f));
+    }
+
+    // Quantizes 4 depth rows (ldx apart) of kLanes columns into kLanes
+    // interleaved groups of 4 bytes
+    static void PackQuad(const float *x, size_t ldx, float inv_scale, float shift, uint8_t *out) {
+        for (size_t l = 0; l < kLanes; ++l)
+            for (size_t t = 0; t < 4; ++t) out[l * 4 + t] = Quantize(x[t * ldx + l], inv_scale, shift);
+    }
+
+    // w: kRows rows of 4 * k4 int8 weights, ldw apart; b: P panels of
+    // k4 x kLanes x 4 uint8 activations, panel_bytes apart. Stores rows x cols
+    // of the tile at (row0, col0) of C.
+    template <size_t P>
+    static void MicroKernel(
+        size_t k4, const int8_t *w, size_t ldw, const uint8_t *b, size_t panel_bytes,
+        float *c, size_t ldc, size_t row0, size_t col0, size_t rows, size_t cols,
+        const Int8Epilogue &epilogue
+    ) {
+        int32_t acc[kRows][P * kLanes] = {};
+        for (size_t q = 0; q < k4; ++q) {
+            for (size_t r = 0; r < kRows; ++r) {
+                const int8_t *a = w + r * ldw + q * 4;
+                for (size_t p = 0; p < P; ++p) {
+                    const uint8_t *panel = b + p * panel_bytes + q * kLanes * 4;
+                    for (size_t l = 0; l < kLanes; ++l) {
+                        int32_t sum = 0;
+                        for (size_t t = 0; t < 4; ++t) sum += int32_t(panel[l * 4 + t]) * int32_t(a[t]);
+                        acc[r][p * kLanes + l] += sum;
+                    }
+                }
+            }
+        }
+        for (size_t r = 0; r < rows; ++r)
+            for (size_t j = 0; j < cols; ++j)
+                c[(row0 + r) * ldc + col0 + j] = epilogue.Apply(acc[r][j], row0 + r, col0 + j);
+    }
+};
@@ -0,0 +1,96 @@
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+
+#pragma once
+
+// Memory order of a rank-4 tensor's elements. shape() is always the logical
+// NCHW shape; only where an element is stored changes.
+//  - NCHW: planes of H x W per (n, c)
+//  - NHWC: channels innermost, pixel by pixel
+//  - NCHW8c / NCHW16c: channels in blocks of 8 / 16 lanes, each block stored as
+//    H x W x lanes, so one pixel's channel block is one SIMD vector. The last
+//    block is zero-padded up to a full vector.
+enum class Layout {
+    NCHW,
+    NHWC,
+    NCHW8c,
+    NCHW16c
+};
+
+inline const char* LayoutName(Layout layout) {
+    switch (layout) {
+        case Layout::NCHW:    return "NCHW";
+        case Layout::NHWC:    return "NHWC";
+        case Layout::NCHW8c:  return "NCHW8c";
+        case Layout::NCHW16c: return "NCHW16c";
+    }
+    return "unknown";
+}
+
+// Channels per block: 1 for the unblocked layouts
+inline size_t ChannelBlock(Layout layout) {
+    switch (layout) {
+        case Layout::NCHW8c:  return 8;
+        case Layout::NCHW16c: return 16;
+        default:              return 1;
+    }
+}
+
+inline bool IsBlocked(Layout layout) { return ChannelBlock(layout) > 1; }
+
+// Elements stored for a tensor of this shape, channel padding included
+inline size_t StorageSize(const std::vector<size_t>& shape, Layout layout) {
+    size_t size = 1;
+    for (size_t dim : shape) size *= dim;
+    if (layout == Layout::NCHW) return size;
+    if (shape.size() != 4) throw std::invalid_argument(std::string(LayoutName(layout)) + " needs a rank-4 shape");
+    const size_t block = ChannelBlock(layout);
+    const size_t channels = (shape[1] + block - 1) / block * block;
+    return shape[0] * channels * shape[2] * shape[3];
+}
+
+// Every layout stores element (n, c, h, w) at
+// PlaneOffset(n, c) + (h * W + w) * PixelStride
+inline size_t PixelStride(const std::vector<size_t>& shape, Layout layout) {
+    if (layout == Layout::NHWC) return shape[1];
+    return ChannelBlock(layout);
+}
+
+inline size_t PlaneOffset(const std::vector<size_t>& shape, Layout layout, size_t n, size_t c) {
+    const size_t channels = shape[1], pixels = shape[2] * shape[3];
+    switch (layout) {
+        case Layout::NCHW: return (n * channels + c) * pixels;
+        case Layout::NHWC: return n * pixels * channels + c;
+        default: {
+            const size_t block = ChannelBlock(layout);
+            const size_t blocks = (channels + block - 1) / block;
+            return (n * blocks + c / block) * pixels * block + c % block;
+        }
+    }
+}
+
+// Copies a tensor of the given logical shape between layouts; padding lanes of a
+// blocked destination are zeroed. src and dst must not overlap.
+inline void Reorder(const float* src, Layout src_layout, float* dst, Layout dst_layout, const std::vector<size_t>& shape) {
+    if (src_layout == dst_layout) {
+        std::copy(src, src + StorageSize(shape, src_layout), dst);
+        return;
+    }
+    const size_t batch = shape[0], channels = shape[1], pixels = shape[2] * shape[3];
+    const size_t src_stride = PixelStride(shape, src_layout);
+    const size_t dst_stride = PixelStride(shape, dst_layout);
+
+    const size_t block = ChannelBlock(dst_layout);
+    if (channels % block != 0) std::fill(dst, dst + StorageSize(shape, dst_layout), 0.0f);
+
+    for (size_t n = 0; n < batch; ++n) {
+        for (size_t c = 0; c < channels; ++c) {
+            const float* s = src + PlaneOffset(shape, src_layout, n, c);
+            float* d = dst + PlaneOffset(shape, dst_layout, n, c);
+            for (size_t pos = 0; pos < pixels; ++pos) d[pos * dst_stride] = s[pos * src_stride];
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#include "Executor.h"
+#include "ReorderOperation.h"
+#include "FastMatMul.h"
+#include <map>
+
+#pragma once
+
+// Picks a storage layout for every step and inserts ReorderOperation steps where
+// a consumer needs an operand in another layout than its producer wrote it in.
+// Each node chooses through preferredLayout(): convolutions that run faster on
+// channel-blocked tensors pick the blocked layout and elementwise nodes follow
+// their first operand, so a conv -> add -> relu -> conv stack stays blocked and
+// is reordered once on the way in and once on the way out. A producer is
+// reordered at most once per layout, however many consumers need it.
+// Graph outputs are always NCHW. Runs after EpilogueFusion.
+class LayoutAssignment {
+public:
+    // blocked is the channel-blocked layout to offer (NCHW8c or NCHW16c); NCHW
+    // keeps every step NCHW. Returns the number of reorder steps inserted.
+    static size_t Apply(Executor& executor, Layout blocked) {
+        std::vector<Executor::Step>& steps = executor.schedule();
+        const size_t count = steps.size();
+
+        // Layouts in schedule order, from the layouts the operands ended up in
+        const std::vector<std::vector<size_t>> shapes = executor.inferShapes();
+        std::vector<Layout> layouts(count, Layout::NCHW);
+        for (size_t i = 0; i < count; ++i) {
+            const Executor::Step& step = steps[i];
+            if (step.skipped) continue;
+            if (const Tensor* held = step.node->value()) {
+                layouts[i] = held->layout();
+                continue;
+            }
+            std::vector<Layout> arg_layouts;
+            std::vector<std::vector<size_t>> arg_shapes;
+            for (size_t k = 0; k < step.nodeInputs(); ++k) {
+                arg_layouts.push_back(layouts[step.inputs[k]]);
+                arg_shapes.push_back(shapes[step.inputs[k]]);
+            }
+            const Layout preferred = step.node->preferredLayout(arg_layouts, arg_shapes, blocked);
+            layouts[i] = step.node->supportsLayout(preferred) ? preferred : Layout::NCHW;
+        }
+
+        // Rebuild the schedule with reorders in front of their first consumer
+        std::vector<Executor::Step> rebuilt;
+        std::vector<size_t> position(count);
+        std::map<std::pair<size_t, Layout>, size_t> reorders;
+        auto reordered = [&](size_t input, Layout layout) {
+            auto [it, inserted] = reorders.try_emplace({input, layout}, rebuilt.size());
+            if (inserted) {
+                // Non-owning: the graph outlives the executor
+                const std::shared_ptr<INode> producer(std::shared_ptr<INode>(), steps[input].node);
+                Executor::Step reorder{executor.adopt(std::make_shared<ReorderOperation>(producer, layout)), {position[input]}, 0};
+                reorder.layout = layout;
+                rebuilt.push_back(reorder);
+            }
+            return it->second;
+        };
+
+        for (size_t i = 0; i < count; ++i) {
+            Executor::Step step = steps[i];
+            step.layout = layouts[i];
+            const bool keeps_input = step.node->kind() == OpKind::Reorder;
+            for (size_t k = 0; k < step.inputs.size(); ++k) {
+                const size_t input = step.inputs[k];
+                // A fused addend is read like the output
+                const Layout wanted = k < step.nodeInputs() ? step.node->inputLayout(k, layouts[i]) : layouts[i];
+                step.inputs[k] = keeps_input || layouts[input] == wanted ? position[input] : reordered(input, wanted);
+            }
+            // A constant addend is reordered here once rather than on every run
+            if (step.addend && step.addend->layout() != layouts[i]) {
+                const INode* held = executor.adopt(std::make_shared<InputData>(step.addend->toLayout(layouts[i])));
+                step.addend = held->value();
+            }
+            position[i] = rebuilt.size();
+            rebuilt.push_back(step);
+        }
+
+        std::vector<size_t>& outputs = executor.outputs();
+        for (size_t& output : outputs) {
+            output = layouts[output] == Layout::NCHW ? position[output] : reordered(output, Layout::NCHW);
+        }
+
+        // Consumers changed, so count uses again
+        for (Executor::Step& step : rebuilt) step.uses = 0;
+        for (const Executor::Step& step : rebuilt) {
+            for (size_t input : step.inputs) rebuilt[input].uses++;
+        }
+        for (size_t output : outputs) rebuilt[output].uses++;
+
+        const size_t inserted = rebuilt.size() - count;
+        steps = std::move(rebuilt);
+        return inserted;
+    }
+
+    // Layout the pass offers on this CPU: one channel block per SIMD register of
+    // the active GEMM backend
+    static Layout PreferredBlockedLayout() {
+        switch (FastMatMul::GetBackend()) {
+            case GemmBackend::Avx512: return Layout::NCHW16c;
+            case GemmBackend::Avx2:   return Layout::NCHW8c;
+            default:                  return Layout::NCHW;
+        }
+    }
+};
@@ -1,90 +1,125 @@
 #include "Operations.h"
 #include "FastMatMul.h"
-#include <iterator>
+#include "Int8Gemm.h"
 
 #pragma once
 
 
-class MatMulOperation : public BinaryOperation {
+class MatMulOperation : public BinaryOperation, public Quantizable {
 public:
     MatMulOperation(const std::shared_ptr<INode> lhs, const std::shared_ptr<INode> rhs): BinaryOperation(lhs, rhs) {}
-    MatMulOperation(const std::shared_ptr<INode> lhs, const Tensor& rhs_tensor): BinaryOperation(lhs, rhs_tensor) {}
-    MatMulOperation(const Tensor& lhs_tensor, const std::shared_ptr<INode> rhs): BinaryOperation(lhs_tensor, rhs) {}
-    MatMulOperation(const Tensor& lhs_tensor, const Tensor& rhs_tensor): BinaryOperation(lhs_tensor, rhs_tensor) {}
-
-    Tensor evaluate() const override {
-        Tensor lhs_tensor;
-        Tensor rhs_tensor;
-        
-        if(lhs_is_node_) lhs_tensor = lhs_->evaluate();
-        else lhs_tensor = lhs_tensor_;
-        if(rhs_is_node_) rhs_tensor = rhs_->evaluate();
-        else rhs_tensor = rhs_tensor_;
+    MatMulOperation(const std::shared_ptr<INode> lhs, Tensor rhs_tensor): BinaryOperation(lhs, std::move(rhs_tensor)) {}
+    MatMulOperation(Tensor lhs_tensor, const std::shared_ptr<INode> rhs): BinaryOperation(std::move(lhs_tensor), rhs) {}
+    MatMulOperation(Tensor lhs_tensor, Tensor rhs_tensor): BinaryOperation(std::move(lhs_tensor), std::move(rhs_tensor)) {}
 
+    using BinaryOperation::compute;
+
+    std::vector<size_t> outputShape(const std::vector<size_t>& lhs_shape, const std::vector<size_t>& rhs_shape) const override {
         // NCHW: [batch, channels, height, width]
-        size_t lhs_batch_size = lhs_tensor.shape()[0];
-        size_t lhs_channels = lhs_tensor.shape()[1];
-        size_t lhs_height = lhs_tensor.shape()[2];
-        size_t lhs_width = lhs_tensor.shape()[3];
+        // Check validity for matrix multiplication
+        if(lhs_shape[0] != rhs_shape[0]) throw std::invalid_argument("Batch size must be same for matrix multiplication.");
+        if(lhs_shape[1] != rhs_shape[1]) throw std::invalid_argument("Channels size must be same for matrix multiplication.");
+        if(lhs_shape[3] != rhs_shape[2]) throw std::invalid_argument("Incompatible dimensions for matrix multiplication.");
 
-        size_t rhs_batch_size = rhs_tensor.shape()[0];
-        size_t rhs_channels = rhs_tensor.shape()[1];
-        size_t rhs_height = rhs_tensor.shape()[2];
-        size_t rhs_width = rhs_tensor.shape()[3];
+        // Output tensor with shape [m, n]
+        return {lhs_shape[0], lhs_shape[1], lhs_shape[2], rhs_shape[3]};
+    }
 
-        // Check validity for matrix multiplication
-        if(lhs_batch_size != rhs_batch_size) throw std::invalid_argument("Batch size must be same for matrix multiplication.");
-        if(lhs_channels != rhs_channels) throw std::invalid_argument("Channels size must be same for matrix multiplication.");
-        if(lhs_width != rhs_height) throw std::invalid_argument("Incompatible dimensions for matrix multiplication.");
-        
-        // Create output tensor with shape [m, n]
-        std::vector<size_t> result_shape = {lhs_batch_size, lhs_channels, lhs_height, rhs_width};
-        std::vector<float> empty_data;
-
-        Tensor result(result_shape, empty_data);
-        for(size_t i = 0; i < result.size(); ++i) result.GetData()[i] = 0;
-        
-        // Old method
-        //for(size_t b = 0; b < lhs_batch_size; ++b)
-        //    for(size_t c = 0; c < lhs_channels; ++c)
-        //        for(size_t i = 0; i < lhs_height; ++i)
-        //            for(size_t j = 0; j < rhs_width; ++j)
-        //                for(size_t k = 0; k < lhs_width; ++k)
-        //                    result.at(b, c, i, j) += lhs_tensor.at(b, c, i, k) * rhs_tensor.at(b, c, k, j);
-
-        // New method
-        std::vector<float> tmp_left;
-        std::vector<float> tmp_right;
-        std::vector<float> tmp_result;
-        size_t lhs_begin_copy_iter = 0;
-        size_t lhs_end_copy_iter = 0;
-        size_t rhs_begin_copy_iter = 0;
-        size_t rhs_end_copy_iter = 0;
-
-        for(size_t b = 0; b < lhs_batch_size; ++b)
-            for(size_t c = 0; c < lhs_channels; ++c){
-                lhs_begin_copy_iter = lhs_tensor.index(b, c, 0, 0);
-                lhs_end_copy_iter = lhs_tensor.index(b, c, lhs_tensor.shape()[2] - 1, lhs_tensor.shape()[3] - 1);
-                rhs_begin_copy_iter = rhs_tensor.index(b, c, 0, 0);
-                rhs_end_copy_iter = rhs_tensor.index(b, c, rhs_tensor.shape()[2] - 1, rhs_tensor.shape()[3] - 1);
-                
-
-                for(size_t i = lhs_begin_copy_iter; i <= lhs_end_copy_iter; ++i)
-                    tmp_left.push_back(lhs_tensor.GetData()[i]);
-                for(size_t i = rhs_begin_copy_iter; i <= rhs_end_copy_iter; ++i)
-                    tmp_right.push_back(rhs_tensor.GetData()[i]);
-                
-                tmp_result = MatrixMultiplyNeon::MatrixMultiplyFast(tmp_left, tmp_right, lhs_height, rhs_width, lhs_width);
-                
-                for(size_t h = 0; h < lhs_height; ++h)
-                    for(size_t w = 0; w < rhs_width; ++w)
-                        result.at(b, c, h, w) = tmp_result[h * rhs_width + w];
-
-                tmp_left.clear();
-                tmp_right.clear();
-                tmp_result.clear();
+    OpKind kind() const override { return OpKind::MatMul; }
+
+    bool fusesEpilogue() const override { return true; }
+
+    // bf16/f16 constant weights stay 16-bit in their packed panels; other 16-bit
+    // operands are widened while packing or up front
+    bool readsHalf() const override { return true; }
+
+    void compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& result) const override {
+        compute(lhs_tensor, rhs_tensor, result, Epilogue());
+    }
+
+    // Bias add and ReLU run inside the GEMM store, see GemmEpilogue
+    void compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& result, const Epilogue& epilogue) const override {
+        outputShape(lhs_tensor.shape(), rhs_tensor.shape());
+        if (epilogue.addend && epilogue.addend->shape() != result.shape()) throw std::invalid_argument("Shapes must match for addition.");
+        checkLayout(lhs_tensor);
+        checkLayout(rhs_tensor);
+        checkLayout(result);
+        if (epilogue.addend) checkLayout(*epilogue.addend);
+        if (result.dtype() != DType::F32) throw std::invalid_argument("MatMul results are f32");
+
+        Tensor addend_scratch;
+        GemmEpilogue gemm_epilogue;
+        gemm_epilogue.addend = epilogue.addend ? inFloat(*epilogue.addend, addend_scratch).data() : nullptr;
+        gemm_epilogue.relu = epilogue.relu;
+
+        if (quantization_ && &rhs_tensor == rhsTensor()) {
+            Tensor lhs_scratch;
+            computeInt8(inFloat(lhs_tensor, lhs_scratch), rhs_tensor, result, gemm_epilogue.addend, epilogue.relu);
+            return;
+        }
+
+        // Constant weights are packed once, so inference only packs the activations;
+        // small f32 slices skip packing altogether in the generic path
+        const size_t n = lhs_tensor.shape(2), k = lhs_tensor.shape(3), m = rhs_tensor.shape(3);
+        const bool small = rhs_tensor.dtype() == DType::F32 && FastMatMul::HasSmallKernel(n, m, k);
+        if (&rhs_tensor == rhsTensor() && result.size() > 0 && !small) {
+            const size_t slices = lhs_tensor.shape(0) * lhs_tensor.shape(1);
+            const std::shared_ptr<const FastMatMul::PackedMatrix> packed = constantForm<FastMatMul::PackedMatrix>(
+                rhs_tensor, ConstantForm::GemmPanels, FastMatMul::TileConfig(), [&] {
+                    Tensor scratch;
+                    const Tensor& weights = inFloat(rhs_tensor, scratch);
+                    return FastMatMul::PrepackBatched(slices, k, m, weights.data(), 1, k, k * m, rhs_tensor.dtype());
+                });
+            gemm_epilogue.ld_addend = n;
+            const GemmEpilogue* fused = epilogue.empty() ? nullptr : &gemm_epilogue;
+            if (lhs_tensor.dtype() != DType::F32) {
+                const auto slice = [&](size_t s) {
+                    return HalfStridedMatrix{lhs_tensor.halfData() + s * n * k, 1, n, lhs_tensor.dtype()};
+                };
+                FastMatMul::GemmPacked(slices, n, slice, *packed, result.data(), n, n * m, fused);
+                return;
             }
+            const auto slice = [&](size_t s) { return StridedMatrix{lhs_tensor.data() + s * n * k, 1, n}; };
+            FastMatMul::GemmPacked(slices, n, slice, *packed, result.data(), n, n * m, fused);
+            return;
+        }
+
+        // Every (b, c) slice straight from and into tensor storage
+        Tensor lhs_scratch, rhs_scratch;
+        FastMatMul::Gemm(
+            ColumnMajorSlices<ConstTensorView>(inFloat(lhs_tensor, lhs_scratch)),
+            ColumnMajorSlices<ConstTensorView>(inFloat(rhs_tensor, rhs_scratch)),
+            ColumnMajorSlices<TensorView>(result),
+            epilogue.empty() ? nullptr : &gemm_epilogue
+        );
+    }
+
+private:
+    // Int8Gemm per slice with the weights as W = B^T(m x k) and the activations as
+    // X = A^T(k x n), both read in place; C = W * X row-major is column-major C
+    void computeInt8(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& result, const float* addend, bool relu) const {
+        const size_t slices = lhs_tensor.shape(0) * lhs_tensor.shape(1);
+        const size_t n = lhs_tensor.shape(2), k = lhs_tensor.shape(3), m = rhs_tensor.shape(3);
+        const std::shared_ptr<const std::vector<Int8Gemm::Weights>> weights = constantForm<std::vector<Int8Gemm::Weights>>(
+            rhs_tensor, ConstantForm::Int8Weights, {}, [&] {
+                Tensor scratch;
+                const float* data = inFloat(rhs_tensor, scratch).data();
+                std::vector<Int8Gemm::Weights> per_slice;
+                for (size_t s = 0; s < slices; ++s)
+                    per_slice.push_back(Int8Gemm::QuantizeWeights(m, k, data + s * k * m, k, 1));
+                return per_slice;
+            });
+        for (size_t s = 0; s < slices; ++s) {
+            Int8Gemm::Run((*weights)[s], lhs_tensor.data() + s * n * k, n, n, *quantization_,
+                          result.data() + s * n * m, n, addend ? addend + s * n * m : nullptr, n, relu);
+        }
+    }
 
-        return result;
+    // Each [height, width] slice of an NCHW tensor read as a column-major matrix,
+    // BLAS style, which is how this operation has always interpreted its operands
+    template <typename View, typename T>
+    static View ColumnMajorSlices(T& tensor) {
+        const std::vector<size_t>& shape = tensor.shape();
+        return View(tensor).reshape({shape[0], shape[1], shape[3], shape[2]}).transpose(2, 3);
     }
 };
\ No newline at end of file
@@ -0,0 +1,22 @@
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include "Layout.h"
+
+#pragma once
+
+// Offsets of every intermediate tensor of a schedule in one shared arena,
+// produced by MemoryPlanner and consumed by Executor::bind.
+struct MemoryPlan {
+    static constexpr size_t kNoBuffer = std::numeric_limits<size_t>::max();
+    static constexpr size_t kAlignment = 16; // floats, i.e. 64 bytes
+
+    std::vector<std::vector<size_t>> shapes; // per schedule step
+    std::vector<Layout> layouts;             // per step, storage layout of the result
+    std::vector<size_t> offsets;             // per step, in floats; kNoBuffer for graph inputs
+    size_t arena_size = 0;                   // floats
+    size_t unplanned_size = 0;               // floats if every result had its own buffer
+
+    size_t peak_bytes() const { return arena_size * sizeof(float); }
+    size_t unplanned_bytes() const { return unplanned_size * sizeof(float); }
+};
@@ -0,0 +1,134 @@
+#include "Executor.h"
+#include "MemoryPlan.h"
+#include <algorithm>
+
+#pragma once
+
+// Builds a MemoryPlan for an executor schedule. Results live from the step that
+// produces them to their last consumer (outputs to the end of the run).
+class MemoryPlanner {
+public:
+    // Greedy by size: the largest tensors are placed first, each at the lowest
+    // offset that does not collide with an already placed, simultaneously live one.
+    // With concurrent set, lifetimes are ordered by graph dependencies rather than
+    // by schedule position, so the plan stays valid when independent steps overlap.
+    static MemoryPlan Plan(const Executor& executor, bool concurrent = false) {
+        const std::vector<Executor::Step>& schedule = executor.schedule();
+        const size_t steps = schedule.size();
+
+        MemoryPlan plan;
+        plan.shapes.resize(steps);
+        plan.layouts.assign(steps, Layout::NCHW);
+        plan.offsets.assign(steps, MemoryPlan::kNoBuffer);
+
+        // Shapes and lifetimes
+        std::vector<size_t> last_use(steps);
+        for (size_t i = 0; i < steps; ++i) {
+            const Executor::Step& step = schedule[i];
+            if (step.skipped) continue;
+            if (const Tensor* held = step.node->value()) {
+                plan.shapes[i] = held->shape();
+                plan.layouts[i] = held->layout();
+            } else {
+                plan.layouts[i] = step.layout;
+                std::vector<std::vector<size_t>> arg_shapes;
+                for (size_t input : step.inputs) arg_shapes.push_back(plan.shapes[input]);
+                if (step.addend_is_input) arg_shapes.pop_back();
+                plan.shapes[i] = step.node->outputShape(arg_shapes);
+
+                const std::vector<size_t>* addend = step.addend ? &step.addend->shape() : nullptr;
+                if (step.addend_is_input) addend = &plan.shapes[step.inputs.back()];
+                const bool bias = addend && step.node->fusesBias() && Epilogue::IsChannelBias(*addend, plan.shapes[i]);
+                if (addend && *addend != plan.shapes[i] && !bias) throw std::invalid_argument("Shapes must match for addition.");
+            }
+            last_use[i] = i;
+            for (size_t input : step.inputs) last_use[input] = i;
+        }
+        for (size_t output : executor.outputs()) last_use[output] = steps;
+
+        // Steps that compute in place write over an operand they are the last reader
+        // of: owner is the step whose buffer a result lives in, and a buffer stays
+        // live until the end of its last owner. Only sequential runs alias, since
+        // concurrent ones order lifetimes by dependencies, step by step.
+        std::vector<size_t> owner(steps), end = last_use;
+        for (size_t i = 0; i < steps; ++i) {
+            owner[i] = i;
+            const Executor::Step& step = schedule[i];
+            if (concurrent || step.skipped || step.node->value() || !step.node->computesInPlace()) continue;
+            for (size_t k = 0; k < step.nodeInputs(); ++k) {
+                const size_t input = step.inputs[k];
+                if (schedule[input].skipped || schedule[input].node->value() || last_use[input] != i) continue;
+                if (std::count(step.inputs.begin(), step.inputs.end(), input) != 1) continue;
+                if (plan.shapes[input] != plan.shapes[i] || plan.layouts[input] != plan.layouts[i]) continue;
+                owner[i] = owner[input];
+                end[owner[i]] = std::max(end[owner[i]], last_use[i]);
+                break;
+            }
+        }
+
+        std::vector<std::vector<bool>> ancestors;
+        std::vector<std::vector<size_t>> consumers;
+        if (concurrent) {
+            ancestors.assign(steps, std::vector<bool>(steps, false));
+            consumers.resize(steps);
+            for (size_t i = 0; i < steps; ++i) {
+                for (size_t input : schedule[i].inputs) {
+                    consumers[input].push_back(i);
+                    ancestors[i][input] = true;
+                    for (size_t j = 0; j < input; ++j) {
+                        if (ancestors[input][j]) ancestors[i][j] = true;
+                    }
+                }
+            }
+        }
+
+        // Whether the buffer of step a is dead before step b starts writing
+        auto finishes_before = [&](size_t a, size_t b) {
+            if (last_use[a] == steps || !ancestors[b][a]) return false;
+            for (size_t consumer : consumers[a]) {
+                if (!ancestors[b][consumer]) return false;
+            }
+            return true;
+        };
+
+        struct Block {
+            size_t step;
+            size_t size;
+        };
+        std::vector<Block> blocks;
+        for (size_t i = 0; i < steps; ++i) {
+            if (schedule[i].skipped || schedule[i].node->value()) continue;
+            size_t size = StorageSize(plan.shapes[i], plan.layouts[i]);
+            size = (size + MemoryPlan::kAlignment - 1) / MemoryPlan::kAlignment * MemoryPlan::kAlignment;
+            if (owner[i] == i) blocks.push_back({i, size});
+            plan.unplanned_size += size;
+        }
+        std::stable_sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) { return a.size > b.size; });
+
+        std::vector<Block> placed;
+        for (const Block& block : blocks) {
+            // Placed blocks live at the same time as this one, by offset
+            std::vector<std::pair<size_t, size_t>> busy;
+            for (const Block& other : placed) {
+                const bool overlap = concurrent
+                    ? !finishes_before(block.step, other.step) && !finishes_before(other.step, block.step)
+                    : block.step <= end[other.step] && other.step <= end[block.step];
+                if (overlap) busy.push_back({plan.offsets[other.step], other.size});
+            }
+            std::sort(busy.begin(), busy.end());
+
+            size_t offset = 0;
+            for (const auto& [start, size] : busy) {
+                if (offset + block.size <= start) break;
+                offset = std::max(offset, start + size);
+            }
+            plan.offsets[block.step] = offset;
+            plan.arena_size = std::max(plan.arena_size, offset + block.size);
+            placed.push_back(block);
+        }
+        for (size_t i = 0; i < steps; ++i) {
+            if (owner[i] != i) plan.offsets[i] = plan.offsets[owner[i]];
+        }
+        return plan;
+    }
+};
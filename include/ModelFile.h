@@ -0,0 +1,344 @@
+#include "NeuralNetwork.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#pragma once
+
+// Read-only mapping of a whole file. Pages come from the page cache, so every
+// process mapping the same file shares them.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("Cannot open " + path);
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        size_ = static_cast<size_t>(status.st_size);
+        void* data = size_ ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        close(fd);
+        if (data == MAP_FAILED) throw std::runtime_error("Cannot map " + path);
+        data_ = static_cast<const unsigned char*>(data);
+    }
+
+    ~MappedFile() {
+        if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+
+// Binary model format, native byte order:
+//   header  magic, version, then offset and size of the two sections
+//   graph   tensor table, then the nodes reachable from the network's last
+//           operation in topological order; the last node is the output
+//   blob    elements of every constant tensor, each at a 64-byte boundary
+// Load() maps the file and wraps the constant operands of the operations
+// around the mapped blob, so startup only parses the graph and weight pages
+// are read on first use, shared between processes. Graph inputs (InputData)
+// hold a copy of their saved value, so they can be set as usual.
+class ModelFile {
+public:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kAlignment = 64; // bytes
+
+    static void Save(const NeuralNetwork& network, const std::string& path) {
+        if (network.getOperations().empty()) throw std::logic_error("Cannot save an empty network");
+        const Executor executor({network.getOperations().back().get()});
+        const std::vector<Executor::Step>& schedule = executor.schedule();
+
+        Writer nodes;
+        std::vector<const Tensor*> tensors;
+        const auto operand = [&](const Tensor* constant, size_t node) {
+            nodes.put<uint64_t>(constant ? kTensorRef : kNodeRef);
+            nodes.put<uint64_t>(constant ? tensors.size() : node);
+            if (constant) tensors.push_back(constant);
+        };
+
+        nodes.put<uint64_t>(schedule.size());
+        for (const Executor::Step& step : schedule) {
+            const INode* node = step.node;
+            const OpKind kind = node->kind();
+            nodes.put<uint32_t>(static_cast<uint32_t>(kind));
+            switch (kind) {
+                case OpKind::Input:
+                    operand(node->value(), 0);
+                    break;
+                case OpKind::Add: case OpKind::Sub: case OpKind::Mul: case OpKind::MatMul: case OpKind::Conv: {
+                    const auto* binary = dynamic_cast<const BinaryOperation*>(node);
+                    if (!binary) throw std::invalid_argument("Cannot save a binary operation of unknown type");
+                    operand(binary->lhsTensor(), binary->lhsTensor() ? 0 : step.inputs[0]);
+                    operand(binary->rhsTensor(), binary->rhsTensor() ? 0 : step.inputs[binary->lhsTensor() ? 0 : 1]);
+                    if (const auto* conv = dynamic_cast<const ConvolOperation*>(node)) {
+                        nodes.put<uint64_t>(conv->getStride());
+                        nodes.put<uint64_t>(conv->getPadding());
+                        nodes.put<uint32_t>(static_cast<uint32_t>(conv->getAlgorithm()));
+                    }
+                    if (const auto* quantizable = dynamic_cast<const Quantizable*>(node)) {
+                        const std::optional<QuantParams>& params = quantizable->getQuantization();
+                        nodes.put<uint32_t>(params.has_value());
+                        nodes.put<float>(params ? params->scale : 1.0f);
+                        nodes.put<int32_t>(params ? params->zero_point : 0);
+                    }
+                    break;
+                }
+                case OpKind::ReLU: case OpKind::Softmax: case OpKind::Reorder: {
+                    const auto* unary = dynamic_cast<const UnaryOperation*>(node);
+                    if (!unary) throw std::invalid_argument("Cannot save a unary operation of unknown type");
+                    operand(unary->argTensor(), unary->argTensor() ? 0 : step.inputs[0]);
+                    if (const auto* softmax = dynamic_cast<const SoftmaxOperation*>(node)) nodes.put<uint64_t>(softmax->getAxis());
+                    if (const auto* reorder = dynamic_cast<const ReorderOperation*>(node)) nodes.put<uint32_t>(static_cast<uint32_t>(reorder->layout()));
+                    break;
+                }
+                default:
+                    throw std::invalid_argument("Cannot save an operation of unknown kind");
+            }
+        }
+
+        // Tensor table, with each tensor's offset in the blob
+        Writer graph;
+        size_t blob_size = 0;
+        graph.put<uint64_t>(tensors.size());
+        for (const Tensor* tensor : tensors) {
+            graph.put<uint32_t>(static_cast<uint32_t>(tensor->dtype()));
+            graph.put<uint32_t>(static_cast<uint32_t>(tensor->layout()));
+            graph.put<uint64_t>(tensor->shape().size());
+            for (size_t dim : tensor->shape()) graph.put<uint64_t>(dim);
+            graph.put<uint64_t>(blob_size);
+            blob_size = Align(blob_size + Bytes(*tensor));
+        }
+        graph.bytes.insert(graph.bytes.end(), nodes.bytes.begin(), nodes.bytes.end());
+
+        Header header;
+        header.graph_offset = Align(sizeof(Header));
+        header.graph_size = graph.bytes.size();
+        header.blob_offset = Align(header.graph_offset + header.graph_size);
+        header.blob_size = blob_size;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) throw std::runtime_error("Cannot create " + path);
+        std::vector<char> padding(kAlignment, 0);
+        const auto pad_to = [&](size_t offset) { file.write(padding.data(), offset - static_cast<size_t>(file.tellp())); };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        pad_to(header.graph_offset);
+        file.write(graph.bytes.data(), graph.bytes.size());
+        for (const Tensor* tensor : tensors) {
+            pad_to(Align(static_cast<size_t>(file.tellp())));
+            file.write(static_cast<const char*>(Storage(*tensor)), Bytes(*tensor));
+        }
+        pad_to(header.blob_offset + header.blob_size);
+        if (!file) throw std::runtime_error("Cannot write " + path);
+    }
+
+    // Network whose operations are the saved nodes in topological order, graph
+    // inputs included, the output last. The mapping lives as long as the
+    // network and the plans compiled from it (see NeuralNetwork::retain).
+    static NeuralNetwork Load(const std::string& path) {
+        const auto file = std::make_shared<const MappedFile>(path);
+        Header header;
+        if (file->size() < sizeof(Header)) throw std::invalid_argument("Not a model file: " + path);
+        std::memcpy(&header, file->data(), sizeof(Header));
+        if (std::memcmp(header.magic, Header().magic, sizeof(header.magic)) != 0) throw std::invalid_argument("Not a model file: " + path);
+        if (header.version != kVersion) throw std::invalid_argument("Unsupported model file version");
+        if (header.graph_offset > file->size() || header.graph_size > file->size() - header.graph_offset ||
+            header.blob_offset > file->size() || header.blob_size > file->size() - header.blob_offset ||
+            header.blob_offset % kAlignment != 0)
+            throw std::invalid_argument("Model file sections are out of bounds");
+
+        Reader graph{file->data() + header.graph_offset, header.graph_size};
+        unsigned char* blob = const_cast<unsigned char*>(file->data() + header.blob_offset);
+
+        // Constants are wrapped, never written: the mapping is read-only
+        struct TensorEntry { std::vector<size_t> shape; DType dtype; Layout layout; void* data; };
+        std::vector<TensorEntry> tensors(graph.count(header.graph_size));
+        for (TensorEntry& entry : tensors) {
+            entry.dtype = graph.enumeration<DType>(DType::F16);
+            entry.layout = graph.enumeration<Layout>(Layout::NCHW16c);
+            entry.shape.resize(graph.count(header.graph_size));
+            if (entry.layout != Layout::NCHW && entry.shape.size() != 4) throw std::invalid_argument("Model tensor layout needs a 4-d shape");
+            for (size_t& dim : entry.shape) dim = graph.get<uint64_t>();
+            const size_t offset = graph.get<uint64_t>();
+            size_t bytes = DTypeSize(entry.dtype);
+            for (size_t dim : entry.shape) {
+                if (dim != 0 && bytes > header.blob_size / dim) throw std::invalid_argument("Model tensor exceeds the weight blob");
+                bytes *= dim;
+            }
+            if (entry.layout != Layout::NCHW) bytes = StorageSize(entry.shape, entry.layout) * DTypeSize(entry.dtype);
+            if (offset % kAlignment != 0 || offset > header.blob_size || bytes > header.blob_size - offset)
+                throw std::invalid_argument("Model tensor exceeds the weight blob");
+            entry.data = blob + offset;
+        }
+
+        std::vector<std::shared_ptr<INode>> nodes(graph.count(header.graph_size));
+        const auto tensor = [&](size_t index) {
+            const TensorEntry& entry = tensors.at(index);
+            return Tensor::Wrap(entry.shape, entry.dtype, entry.data, entry.layout);
+        };
+        NeuralNetwork network;
+        network.retain(file);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            // Operand: a node saved earlier or a constant tensor
+            struct Operand { std::shared_ptr<INode> node; Tensor tensor; };
+            const auto operand = [&]() {
+                const uint64_t ref = graph.get<uint64_t>(), index = graph.get<uint64_t>();
+                if (ref == kTensorRef) return Operand{nullptr, tensor(index)};
+                if (ref != kNodeRef || index >= i) throw std::invalid_argument("Model node refers to a later node");
+                return Operand{nodes[index], Tensor()};
+            };
+            const auto binary = [&](auto make) -> std::shared_ptr<INode> {
+                Operand lhs = operand(), rhs = operand();
+                if (lhs.node && rhs.node) return make(lhs.node, rhs.node);
+                if (lhs.node) return make(lhs.node, std::move(rhs.tensor));
+                if (rhs.node) return make(std::move(lhs.tensor), rhs.node);
+                return make(std::move(lhs.tensor), std::move(rhs.tensor));
+            };
+            const auto unary = [&](auto make) -> std::shared_ptr<INode> {
+                Operand arg = operand();
+                return arg.node ? make(arg.node) : make(std::move(arg.tensor));
+            };
+            const auto quantization = [&](const std::shared_ptr<INode>& node) {
+                const bool quantized = graph.get<uint32_t>() != 0;
+                QuantParams params;
+                params.scale = graph.get<float>();
+                params.zero_point = graph.get<int32_t>();
+                if (quantized) dynamic_cast<Quantizable&>(*node).setQuantization(params);
+            };
+
+            std::shared_ptr<INode>& node = nodes[i];
+            switch (graph.enumeration<OpKind>(OpKind::Reorder)) {
+                case OpKind::Input: {
+                    const Operand value = operand();
+                    if (value.node) throw std::invalid_argument("Model input must hold a tensor");
+                    node = std::make_shared<InputData>(value.tensor);
+                    break;
+                }
+                case OpKind::Add:
+                    node = binary([](auto lhs, auto rhs) { return std::make_shared<ScalarAddOperation>(std::move(lhs), std::move(rhs)); });
+                    break;
+                case OpKind::Sub:
+                    node = binary([](auto lhs, auto rhs) { return std::make_shared<ScalarSubOperation>(std::move(lhs), std::move(rhs)); });
+                    break;
+                case OpKind::Mul:
+                    node = binary([](auto lhs, auto rhs) { return std::make_shared<ScalarMulOperation>(std::move(lhs), std::move(rhs)); });
+                    break;
+                case OpKind::MatMul:
+                    node = binary([](auto lhs, auto rhs) { return std::make_shared<MatMulOperation>(std::move(lhs), std::move(rhs)); });
+                    quantization(node);
+                    break;
+                case OpKind::Conv: {
+                    Operand lhs = operand(), rhs = operand();
+                    const size_t stride = graph.get<uint64_t>(), padding = graph.get<uint64_t>();
+                    if (stride == 0) throw std::invalid_argument("Model convolution has stride 0");
+                    std::shared_ptr<ConvolOperation> conv;
+                    if (lhs.node && rhs.node) conv = std::make_shared<ConvolOperation>(lhs.node, rhs.node, stride, padding);
+                    else if (lhs.node) conv = std::make_shared<ConvolOperation>(lhs.node, std::move(rhs.tensor), stride, padding);
+                    else if (rhs.node) conv = std::make_shared<ConvolOperation>(std::move(lhs.tensor), rhs.node, stride, padding);
+                    else conv = std::make_shared<ConvolOperation>(std::move(lhs.tensor), std::move(rhs.tensor), stride, padding);
+                    conv->setAlgorithm(graph.enumeration<ConvAlgorithm>(ConvAlgorithm::Winograd4x4));
+                    node = conv;
+                    quantization(node);
+                    break;
+                }
+                case OpKind::ReLU:
+                    node = unary([](auto arg) { return std::make_shared<ReLUOperation>(std::move(arg)); });
+                    break;
+                case OpKind::Softmax: {
+                    Operand arg = operand();
+                    const size_t axis = graph.get<uint64_t>();
+                    node = arg.node ? std::make_shared<SoftmaxOperation>(arg.node, axis) : std::make_shared<SoftmaxOperation>(std::move(arg.tensor), axis);
+                    break;
+                }
+                case OpKind::Reorder: {
+                    Operand arg = operand();
+                    const Layout layout = graph.enumeration<Layout>(Layout::NCHW16c);
+                    node = arg.node ? std::make_shared<ReorderOperation>(arg.node, layout) : std::make_shared<ReorderOperation>(std::move(arg.tensor), layout);
+                    break;
+                }
+                default:
+                    throw std::invalid_argument("Model node has an unknown kind");
+            }
+            network.addOp(node);
+        }
+        if (nodes.empty()) throw std::invalid_argument("Model file has no nodes");
+        return network;
+    }
+
+private:
+    static constexpr uint64_t kNodeRef = 0, kTensorRef = 1;
+
+    struct Header {
+        char magic[8] = {'N', 'N', 'M', 'O', 'D', 'E', 'L', '\0'};
+        uint32_t version = kVersion;
+        uint32_t reserved = 0;
+        uint64_t graph_offset = 0, graph_size = 0;
+        uint64_t blob_offset = 0, blob_size = 0;
+    };
+
+    struct Writer {
+        std::vector<char> bytes;
+
+        template <typename T>
+        void put(T value) {
+            const char* raw = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), raw, raw + sizeof(T));
+        }
+    };
+
+    // Bounds-checked reads from the graph section
+    struct Reader {
+        const unsigned char* data;
+        size_t size;
+        size_t pos = 0;
+
+        template <typename T>
+        T get() {
+            if (size - pos < sizeof(T)) throw std::invalid_argument("Model graph section is truncated");
+            T value;
+            std::memcpy(&value, data + pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+
+        // Enum stored as uint32, last being its largest value
+        template <typename Enum>
+        Enum enumeration(Enum last) {
+            const uint32_t value = get<uint32_t>();
+            if (value > static_cast<uint32_t>(last)) throw std::invalid_argument("Model graph holds an unknown enum value");
+            return static_cast<Enum>(value);
+        }
+
+        // Element count, which cannot exceed the section size
+        size_t count(size_t limit) {
+            const uint64_t value = get<uint64_t>();
+            if (value > limit) throw std::invalid_argument("Model graph holds an implausible count");
+            return value;
+        }
+    };
+
+    static size_t Align(size_t bytes) { return (bytes + kAlignment - 1) / kAlignment * kAlignment; }
+
+    static size_t Bytes(const Tensor& tensor) { return tensor.size() * DTypeSize(tensor.dtype()); }
+
+    static const void* Storage(const Tensor& tensor) {
+        if (tensor.dtype() == DType::F32) return tensor.data();
+        return tensor.halfData();
+    }
+};
@@ -5,30 +5,158 @@
 #include "ReLUOperation.h"
 #include "SoftmaxOperation.h"
 #include "ConvolOperation.h"
+#include "ReorderOperation.h"
+#include "Executor.h"
+#include "ExecutionPlan.h"
+#include "MemoryPlanner.h"
+#include "FusionPass.h"
+#include "LayoutPass.h"
+#include "Calibration.h"
 #include <unordered_set>
 
 #pragma once
 
 class NeuralNetwork {
 private:
+    std::vector<std::shared_ptr<const void>> storage_; // see retain(), outlives operations_
     std::vector<std::shared_ptr<INode>> operations_;
+    Executor executor_;
+    bool scheduled_ = false;
+
+    // Steps that may run at the same time (inter-op parallelism)
+    size_t inter_op_threads_ = 1;
+
+    // Channel-blocked layout convolution stacks may run in, NCHW for none
+    Layout blocked_layout_ = LayoutAssignment::PreferredBlockedLayout();
+
+    // Every intermediate lives in arena_ at the offset given by plan_
+    MemoryPlan plan_;
+    Tensor arena_;
+    std::vector<Tensor> slots_;
+
+    // Schedules, fuses and plans the graph, again whenever an input changed shape
+    void prepare() {
+        if (scheduled_) {
+            const auto& schedule = executor_.schedule();
+            for (size_t i = 0; i < schedule.size(); ++i) {
+                const Tensor* held = schedule[i].node->value();
+                if (held && (held->shape() != plan_.shapes[i] || held->layout() != plan_.layouts[i])) {
+                    scheduled_ = false;
+                    break;
+                }
+            }
+        }
+        if (scheduled_) return;
+
+        executor_ = schedule();
+        plan_ = MemoryPlanner::Plan(executor_, inter_op_threads_ > 1);
+
+        // Allocator buffers start at a 64-byte boundary, as the plan offsets assume
+        slots_.clear();
+        arena_ = Tensor({plan_.arena_size}, Tensor::Uninitialized());
+        slots_ = executor_.bind(plan_, arena_.data());
+        scheduled_ = true;
+    }
 
 public:
     // Add operation
     std::shared_ptr<INode> addOp(std::shared_ptr<INode> op) {
         operations_.push_back(op);
+        scheduled_ = false;
         return op;
     }
     
+    // Evaluates the last added operation; every node it depends on runs once,
+    // writing into the preallocated arena
     Tensor infer() {
         if (operations_.empty()) return Tensor();
-        return operations_.back()->evaluate();
+        prepare();
+        executor_.run(slots_, inter_op_threads_);
+        return executor_.result(slots_, executor_.outputs().front());
+    }
+
+    // Schedule of the last added operation with the graph passes applied, as
+    // infer() and compile() run it (e.g. for CodeGen)
+    Executor schedule() const {
+        if (operations_.empty()) throw std::logic_error("Cannot schedule an empty network");
+        Executor executor({operations_.back().get()});
+        EpilogueFusion::Apply(executor);
+        LayoutAssignment::Apply(executor, blocked_layout_);
+        return executor;
+    }
+
+    // Immutable plan of the last added operation for repeated inference, see
+    // ExecutionPlan: same passes and results as infer(), with shapes checked and
+    // kernels selected once here. Runs sequentially, in an arena of its own.
+    std::shared_ptr<const ExecutionPlan> compile() const {
+        if (operations_.empty()) throw std::logic_error("Cannot compile an empty network");
+        return std::make_shared<const ExecutionPlan>(schedule(), operations_, storage_);
+    }
+
+    // Independent branches of the graph run concurrently on up to num_threads
+    // threads; 0 means one per hardware thread. Replans the arena on next infer().
+    void setInterOpThreads(size_t num_threads) {
+        if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+        if (ThreadPool::Shared().NumThreads() < num_threads) ThreadPool::Shared().Resize(num_threads);
+        if ((num_threads > 1) != (inter_op_threads_ > 1)) scheduled_ = false;
+        inter_op_threads_ = num_threads;
+    }
+
+    size_t getInterOpThreads() const { return inter_op_threads_; }
+
+    // Channel-blocked layout (NCHW8c or NCHW16c) that convolutions expected to run
+    // faster in it are switched to, with reorders at the boundaries; NCHW keeps the
+    // whole graph NCHW. Defaults to the vector width of the GEMM backend.
+    void setBlockedLayout(Layout layout) {
+        if (layout != Layout::NCHW && !IsBlocked(layout)) throw std::invalid_argument("Expected a channel-blocked layout or NCHW");
+        if (layout != blocked_layout_) scheduled_ = false;
+        blocked_layout_ = layout;
+    }
+
+    Layout getBlockedLayout() const { return blocked_layout_; }
+
+    // Threads each MatMul/Conv GEMM may use (intra-op parallelism), shared process-wide
+    void setIntraOpThreads(size_t num_threads) { FastMatMul::SetNumThreads(num_threads); }
+
+    size_t getIntraOpThreads() const { return FastMatMul::GetNumThreads(); }
+
+    // Arena layout used by infer(), including the planned peak
+    const MemoryPlan& memoryPlan() {
+        if (operations_.empty()) throw std::logic_error("Cannot plan an empty network");
+        prepare();
+        return plan_;
     }
     
+    // Calibrates the network on samples fed through input and runs its
+    // convolutions and constant-weight matmuls in int8 from then on, see
+    // Calibrator. Returns the number of operations quantized.
+    size_t quantize(InputData& input, const std::vector<Tensor>& samples) {
+        if (operations_.empty()) throw std::logic_error("Cannot quantize an empty network");
+        scheduled_ = false;
+        return Calibrator::Calibrate(operations_.back().get(), input, samples);
+    }
+
+    // Stores the constant weights of every MatMul and Conv as dtype, e.g. bf16
+    // to halve their memory; the GEMMs still accumulate in f32
+    void setWeightType(DType dtype) {
+        for (const std::shared_ptr<INode>& op : operations_) {
+            if (op->kind() != OpKind::MatMul && op->kind() != OpKind::Conv) continue;
+            if (auto* binary = dynamic_cast<BinaryOperation*>(op.get())) binary->setRhsDType(dtype);
+        }
+    }
+
+    // Keeps memory that constant tensors of the operations reference, e.g. a
+    // mapped model file, alive as long as the network and its compiled plans
+    void retain(std::shared_ptr<const void> storage) { storage_.push_back(std::move(storage)); }
+
     // Get all operations in the network
     const std::vector<std::shared_ptr<INode>>& getOperations() const { return operations_; }
     
     // Clear all operations
-    void clear() { operations_.clear(); }
+    void clear() {
+        operations_.clear();
+        storage_.clear(); // after the operations referencing it
+        scheduled_ = false;
+    }
     
 };
\ No newline at end of file
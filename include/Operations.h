@@ -1,14 +1,144 @@
 #include "Tensor.h"
+#include "ConstantCache.h"
+#include "Elementwise.h"
+#include "Broadcast.h"
 #include <concepts>
 #include <type_traits>
 #include <iostream>
+#include <algorithm>
+#include <string>
 
 #pragma once
 
 
+enum class OpKind {
+    Input,
+    Add,
+    Sub,
+    Mul,
+    MatMul,
+    Conv,
+    ReLU,
+    Softmax,
+    Reorder,
+    Other
+};
+
+
+// Elementwise tail a fusion pass folds into a node: output = relu(result + addend)
+struct Epilogue {
+    const Tensor* addend = nullptr; // same shape as the output, or a channel bias for nodes that fusesBias()
+    bool relu = false;
+
+    bool empty() const { return !addend && !relu; }
+
+    // Whether addend is a per-channel bias [1, C, 1, 1] of an output shape
+    static bool IsChannelBias(const std::vector<size_t>& addend, const std::vector<size_t>& output) {
+        return output.size() == 4 && addend == std::vector<size_t>{1, output[1], 1, 1};
+    }
+
+    // Separate pass over a finished output, for nodes that cannot fuse it
+    void apply(Tensor& output) const {
+        if (empty()) return;
+        if (addend && addend->shape() != output.shape()) throw std::invalid_argument("Shapes must match for addition.");
+        Tensor reordered;
+        if (addend && addend->layout() != output.layout()) reordered = addend->toLayout(output.layout());
+        float* out = output.data();
+        if (!addend) Elementwise::Relu(out, out, output.size());
+        else Elementwise::Binary(ElementwiseOp::Add, out, reordered.data() ? reordered.data() : addend->data(), out, output.size(), relu);
+    }
+};
+
+
 class INode {
 public:
+    virtual ~INode() = default;
+
+    // Recursive pull: evaluates the whole subgraph below this node
     virtual Tensor evaluate() const = 0;
+
+    // Node operands, in the order compute() expects their results
+    virtual std::vector<INode*> inputs() const { return {}; }
+
+    // Output shape for the given input shapes (one per inputs() entry); throws on mismatch
+    virtual std::vector<size_t> outputShape(const std::vector<std::vector<size_t>>& arg_shapes) const = 0;
+
+    // Writes the result into output, already allocated with outputShape(); every
+    // element must be written, output may be uninitialized
+    virtual void compute(const std::vector<const Tensor*>& args, Tensor& output) const = 0;
+
+    // Result from already evaluated inputs (one tensor per inputs() entry), stored in layout
+    Tensor compute(const std::vector<const Tensor*>& args, const Epilogue& epilogue = Epilogue(), Layout layout = Layout::NCHW) const {
+        std::vector<std::vector<size_t>> arg_shapes;
+        for (const Tensor* arg : args) arg_shapes.push_back(arg->shape());
+        Tensor output(outputShape(arg_shapes), layout, Tensor::Uninitialized());
+        if (epilogue.empty()) compute(args, output);
+        else compute(args, output, epilogue);
+        return output;
+    }
+
+    // compute() followed by an epilogue; nodes with fusesEpilogue() do both in one pass
+    virtual void compute(const std::vector<const Tensor*>& args, Tensor& output, const Epilogue& epilogue) const {
+        compute(args, output);
+        epilogue.apply(output);
+    }
+
+    virtual bool fusesEpilogue() const { return false; }
+
+    // Whether the fused epilogue addend may also be a per-channel bias, read as
+    // C floats instead of an output-shaped tensor
+    virtual bool fusesBias() const { return false; }
+
+    // Whether compute() accepts an output sharing storage with a node operand of
+    // the same shape and layout. Executors then run the step in place over an
+    // operand nothing reads afterwards.
+    virtual bool computesInPlace() const { return false; }
+
+    virtual OpKind kind() const { return OpKind::Other; }
+
+    // Tensor owned by the node that executors may read in place instead of computing
+    virtual const Tensor* value() const { return nullptr; }
+
+    // Whether compute() handles node operands and an output stored in this layout.
+    // Constant operands may stay NCHW; every node handles NCHW.
+    virtual bool supportsLayout(Layout layout) const { return layout == Layout::NCHW; }
+
+    // Layout the node wants to compute in, given its node operands' current layouts
+    // and shapes; blocked is the channel-blocked layout that suits the CPU.
+    // LayoutAssignment reorders operands that do not match.
+    virtual Layout preferredLayout(const std::vector<Layout>& /*arg_layouts*/,
+                                   const std::vector<std::vector<size_t>>& /*arg_shapes*/,
+                                   Layout /*blocked*/) const {
+        return Layout::NCHW;
+    }
+
+    // Layout operand input (an inputs() index) must have when the node computes in layout
+    virtual Layout inputLayout(size_t /*input*/, Layout layout) const { return layout; }
+
+    // Whether compute() takes bf16/f16 operands; results are always f32
+    virtual bool readsHalf() const { return false; }
+
+protected:
+    void checkLayout(const Tensor& tensor) const {
+        if (!supportsLayout(tensor.layout()))
+            throw std::invalid_argument(std::string("Operation does not support the ") + LayoutName(tensor.layout()) + " layout");
+        if (tensor.dtype() != DType::F32 && !readsHalf())
+            throw std::invalid_argument(std::string("Operation does not support ") + DTypeName(tensor.dtype()) + " tensors");
+    }
+
+    // tensor as f32: itself, or a widened copy kept in scratch
+    static const Tensor& inFloat(const Tensor& tensor, Tensor& scratch) {
+        if (tensor.dtype() == DType::F32) return tensor;
+        scratch = tensor.toDType(DType::F32);
+        return scratch;
+    }
+
+    // tensor stored in layout: itself, or a reordered copy kept in scratch
+    static const Tensor& inLayout(const Tensor& tensor, Layout layout, Tensor& scratch) {
+        if (tensor.layout() == layout) return tensor;
+        scratch = tensor.toLayout(layout);
+        return scratch;
+    }
 };
 
 
@@ -23,6 +153,20 @@ public:
     virtual Tensor evaluate() const override {
         return tensor_;
     }
+
+    virtual std::vector<size_t> outputShape(const std::vector<std::vector<size_t>>&) const override {
+        return tensor_.shape();
+    }
+
+    using INode::compute;
+
+    virtual void compute(const std::vector<const Tensor*>&, Tensor& output) const override {
+        std::copy(tensor_.data(), tensor_.data() + tensor_.size(), output.data());
+    }
+
+    virtual const Tensor* value() const override { return &tensor_; }
+
+    virtual OpKind kind() const override { return OpKind::Input; }
     
     void setTensor(const Tensor& tensor) {
         tensor_ = tensor;
@@ -43,19 +187,139 @@ public:
         args_.push_back(lhs.get());
         args_.push_back(rhs.get());
     }
-    BinaryOperation(const std::shared_ptr<INode> lhs, const Tensor& rhs_tensor)
-        : lhs_(lhs), rhs_tensor_(rhs_tensor), lhs_is_node_(1), rhs_is_node_(0) {
+    // Constant operands are taken by value: moving in an external tensor (e.g.
+    // weights in a mapped model file) keeps it external instead of copying it
+    BinaryOperation(const std::shared_ptr<INode> lhs, Tensor rhs_tensor)
+        : lhs_(lhs), rhs_tensor_(std::move(rhs_tensor)), lhs_is_node_(1), rhs_is_node_(0) {
         args_.push_back(lhs.get());
     }
-    BinaryOperation(const Tensor& lhs_tensor, const std::shared_ptr<INode> rhs)
-        : rhs_(rhs), lhs_tensor_(lhs_tensor), lhs_is_node_(0), rhs_is_node_(1) {
+    BinaryOperation(Tensor lhs_tensor, const std::shared_ptr<INode> rhs)
+        : rhs_(rhs), lhs_tensor_(std::move(lhs_tensor)), lhs_is_node_(0), rhs_is_node_(1) {
         args_.push_back(rhs.get());
     }
-    BinaryOperation(const Tensor& lhs_tensor, const Tensor& rhs_tensor)
-        : lhs_tensor_(lhs_tensor), rhs_tensor_(rhs_tensor), lhs_is_node_(0), rhs_is_node_(0) {}
+    BinaryOperation(Tensor lhs_tensor, Tensor rhs_tensor)
+        : lhs_tensor_(std::move(lhs_tensor)), rhs_tensor_(std::move(rhs_tensor)), lhs_is_node_(0), rhs_is_node_(0) {}
 
     virtual ~BinaryOperation() = default;
-    virtual Tensor evaluate() const override = 0;
+
+    virtual Tensor evaluate() const override {
+        if(lhs_is_node_ && rhs_is_node_) return compute(lhs_->evaluate(), rhs_->evaluate());
+        if(lhs_is_node_) return compute(lhs_->evaluate(), rhs_tensor_);
+        if(rhs_is_node_) return compute(lhs_tensor_, rhs_->evaluate());
+        return compute(lhs_tensor_, rhs_tensor_);
+    }
+
+    virtual std::vector<INode*> inputs() const override { return args_; }
+
+    virtual std::vector<size_t> outputShape(const std::vector<std::vector<size_t>>& arg_shapes) const override {
+        const std::vector<size_t>& lhs = lhs_is_node_ ? arg_shapes[0] : lhs_tensor_.shape();
+        const std::vector<size_t>& rhs = rhs_is_node_ ? arg_shapes[lhs_is_node_ ? 1 : 0] : rhs_tensor_.shape();
+        return outputShape(lhs, rhs);
+    }
+
+    using INode::compute;
+
+    virtual void compute(const std::vector<const Tensor*>& args, Tensor& output) const override {
+        const Tensor& lhs = lhs_is_node_ ? *args[0] : lhs_tensor_;
+        const Tensor& rhs = rhs_is_node_ ? *args[lhs_is_node_ ? 1 : 0] : rhs_tensor_;
+        compute(lhs, rhs, output);
+    }
+
+    virtual void compute(const std::vector<const Tensor*>& args, Tensor& output, const Epilogue& epilogue) const override {
+        const Tensor& lhs = lhs_is_node_ ? *args[0] : lhs_tensor_;
+        const Tensor& rhs = rhs_is_node_ ? *args[lhs_is_node_ ? 1 : 0] : rhs_tensor_;
+        compute(lhs, rhs, output, epilogue);
+    }
+
+    virtual void compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& output, const Epilogue& epilogue) const {
+        compute(lhs_tensor, rhs_tensor, output);
+        epilogue.apply(output);
+    }
+
+    // Constant operand given at construction, nullptr when that side is a node
+    const Tensor* lhsTensor() const { return lhs_is_node_ ? nullptr : &lhs_tensor_; }
+    const Tensor* rhsTensor() const { return rhs_is_node_ ? nullptr : &rhs_tensor_; }
+
+    // Forms derived from the constant operands so far, see constantForm()
+    size_t cachedConstants() const { return constants_.size(); }
+
+    // Must not run concurrently with compute()
+    void clearConstantCache() { constants_.clear(); }
+
+    // Stores the constant rhs operand (e.g. weights) as dtype, for nodes that
+    // readsHalf(); forms derived from it are rebuilt. Must not run concurrently with compute().
+    void setRhsDType(DType dtype) {
+        if (rhs_is_node_ || rhs_tensor_.dtype() == dtype) return;
+        if (dtype != DType::F32 && !readsHalf()) throw std::invalid_argument(std::string("Operation does not support ") + DTypeName(dtype) + " tensors");
+        rhs_tensor_ = rhs_tensor_.toDType(dtype);
+        constants_.clear();
+    }
+
+    // Output is stored like the first node operand
+    Tensor compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor) const {
+        const Layout layout = lhs_is_node_ || !rhs_is_node_ ? lhs_tensor.layout() : rhs_tensor.layout();
+        Tensor output(outputShape(lhs_tensor.shape(), rhs_tensor.shape()), layout, Tensor::Uninitialized());
+        compute(lhs_tensor, rhs_tensor, output);
+        return output;
+    }
+
+    // The operation itself, operands already resolved to tensors
+    virtual std::vector<size_t> outputShape(const std::vector<size_t>& lhs_shape, const std::vector<size_t>& rhs_shape) const = 0;
+    virtual void compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& output) const = 0;
+
+protected:
+    // make() applied to operand, e.g. weights packed for the GEMM: built once per
+    // key when operand is one of this node's constants, on every call when it is a
+    // node result. config holds whatever else the form depends on.
+    template <typename T, typename Make>
+    std::shared_ptr<const T> constantForm(const Tensor& operand, ConstantForm form, ConstantCache::Key config, Make&& make) const {
+        const bool is_lhs = &operand == lhsTensor();
+        if (!is_lhs && &operand != rhsTensor()) return std::make_shared<const T>(make());
+        config.insert(config.begin(), {is_lhs ? size_t(0) : size_t(1), static_cast<size_t>(form)});
+        return constants_.get<T>(config, make);
+    }
+
+    // INode::inLayout, with constant operands reordered only once
+    const Tensor& inLayout(const Tensor& tensor, Layout layout, Tensor& scratch) const {
+        if (tensor.layout() == layout || (&tensor != lhsTensor() && &tensor != rhsTensor()))
+            return INode::inLayout(tensor, layout, scratch);
+        const std::shared_ptr<const Tensor> reordered = constantForm<Tensor>(
+            tensor, ConstantForm::Reordered, {static_cast<size_t>(layout)}, [&] { return tensor.toLayout(layout); });
+        scratch = Tensor::Wrap(reordered->shape(), const_cast<float*>(reordered->data()), layout);
+        return scratch;
+    }
+
+    // output = lhs op rhs for the elementwise operations: operands are read in the
+    // output's layout and broadcast to its shape without being expanded
+    void elementwise(ElementwiseOp op, const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& output) const {
+        checkLayout(lhs_tensor);
+        checkLayout(rhs_tensor);
+        Tensor lhs_scratch, rhs_scratch;
+        const Tensor& lhs = inLayout(lhs_tensor, output.layout(), lhs_scratch);
+        const Tensor& rhs = inLayout(rhs_tensor, output.layout(), rhs_scratch);
+        if (lhs.shape() == output.shape() && rhs.shape() == output.shape()) {
+            Elementwise::Binary(op, lhs.data(), rhs.data(), output.data(), output.size());
+            return;
+        }
+        const Layout layout = output.layout();
+        Elementwise::Binary(op, lhs.data(), BroadcastStrides(lhs.shape(), output.shape(), layout),
+                            rhs.data(), BroadcastStrides(rhs.shape(), output.shape(), layout),
+                            output.data(), StorageDims(output.shape(), layout));
+    }
+
+    // Elementwise operations follow their first node operand's layout; operands
+    // of another rank than 4 only broadcast in NCHW
+    Layout elementwiseLayout(const std::vector<Layout>& arg_layouts, const std::vector<std::vector<size_t>>& arg_shapes) const {
+        if (arg_layouts.empty()) return Layout::NCHW;
+        for (const std::vector<size_t>& shape : arg_shapes) {
+            if (shape.size() != 4) return Layout::NCHW;
+        }
+        if ((!lhs_is_node_ && lhs_tensor_.shape().size() != 4) || (!rhs_is_node_ && rhs_tensor_.shape().size() != 4)) return Layout::NCHW;
+        return arg_layouts.front();
+    }
+
+private:
+    ConstantCache constants_;
 };
 
 
@@ -73,5 +337,35 @@ public:
     UnaryOperation(const Tensor& tensor): tensor_(tensor), is_node_(0) {}
 
     virtual ~UnaryOperation() = default;
-    virtual Tensor evaluate() const override = 0;
+
+    virtual Tensor evaluate() const override {
+        if(is_node_) return compute(arg_->evaluate());
+        return compute(tensor_);
+    }
+
+    virtual std::vector<INode*> inputs() const override { return args_; }
+
+    virtual std::vector<size_t> outputShape(const std::vector<std::vector<size_t>>& arg_shapes) const override {
+        return outputShape(is_node_ ? arg_shapes[0] : tensor_.shape());
+    }
+
+    using INode::compute;
+
+    virtual void compute(const std::vector<const Tensor*>& args, Tensor& output) const override {
+        compute(is_node_ ? *args[0] : tensor_, output);
+    }
+
+    Tensor compute(const Tensor& input) const {
+        Tensor output(outputShape(input.shape()), outputLayout(input.layout()), Tensor::Uninitialized());
+        compute(input, output);
+        return output;
+    }
+
+    // Constant operand given at construction, nullptr when it is a node
+    const Tensor* argTensor() const { return is_node_ ? nullptr : &tensor_; }
+
+    // The operation itself, operand already resolved to a tensor
+    virtual std::vector<size_t> outputShape(const std::vector<size_t>& input_shape) const { return input_shape; }
+    virtual Layout outputLayout(Layout input_layout) const { return input_layout; }
+    virtual void compute(const Tensor& input, Tensor& output) const = 0;
 };
\ No newline at end of file
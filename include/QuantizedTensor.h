@@ -0,0 +1,141 @@
+#include "Tensor.h"
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#pragma once
+
+// Affine int8 quantization: real = scale * (q - zero_point)
+struct QuantParams {
+    float scale = 1.0f;
+    int32_t zero_point = 0;
+
+    // Asymmetric parameters covering [min, max]; the range is widened to include
+    // 0 so that zero padding stays exact
+    static QuantParams FromRange(float min, float max) {
+        min = std::min(min, 0.0f);
+        max = std::max(max, 0.0f);
+        QuantParams params;
+        if (max == min) return params;
+        params.scale = (max - min) / 255.0f;
+        const float zero_point = -128.0f - min / params.scale;
+        params.zero_point = static_cast<int32_t>(std::lround(std::clamp(zero_point, -128.0f, 127.0f)));
+        return params;
+    }
+
+    // Symmetric parameters for values within [-max_abs, max_abs], mapped to
+    // [-127, 127] so that negating a value never overflows
+    static QuantParams Symmetric(float max_abs) {
+        QuantParams params;
+        if (max_abs > 0.0f) params.scale = max_abs / 127.0f;
+        return params;
+    }
+
+    int8_t Quantize(float value) const {
+        const float q = std::nearbyint(value / scale) + static_cast<float>(zero_point);
+        return static_cast<int8_t>(std::clamp(q, -128.0f, 127.0f));
+    }
+
+    float Dequantize(int8_t q) const { return scale * static_cast<float>(q - zero_point); }
+};
+
+
+// int8 tensor with either one QuantParams for every element or one per slice
+// along axis (per-channel quantization, e.g. per output channel of a weight).
+// Elements are stored in NCHW order like Tensor's default layout.
+class QuantizedTensor {
+public:
+    static constexpr size_t kPerTensor = std::numeric_limits<size_t>::max();
+
+    QuantizedTensor() = default;
+
+    QuantizedTensor(const std::vector<size_t>& shape, std::vector<QuantParams> params, size_t axis = kPerTensor)
+        : shape_(shape), params_(std::move(params)), axis_(axis) {
+        size_t size = 1;
+        for (size_t dim : shape_) size *= dim;
+        data_.assign(size, 0);
+        const size_t expected = axis_ == kPerTensor ? 1 : axis_ < shape_.size() ? shape_[axis_] : 0;
+        if (params_.size() != expected) throw std::invalid_argument("Expected one set of quantization parameters per tensor or per slice of the axis");
+    }
+
+    // Quantizes tensor with the given parameters
+    static QuantizedTensor Quantize(const Tensor& tensor, std::vector<QuantParams> params, size_t axis = kPerTensor) {
+        if (tensor.layout() != Layout::NCHW) throw std::invalid_argument("Only NCHW tensors can be quantized");
+        QuantizedTensor result(tensor.shape(), std::move(params), axis);
+        for (size_t i = 0; i < result.size(); ++i) result.data_[i] = result.paramsAt(i).Quantize(tensor.data()[i]);
+        return result;
+    }
+
+    // Asymmetric per-tensor quantization over the tensor's own range
+    static QuantizedTensor Quantize(const Tensor& tensor) {
+        const float* data = tensor.data();
+        const auto [min, max] = std::minmax_element(data, data + tensor.size());
+        return Quantize(tensor, {tensor.size() ? QuantParams::FromRange(*min, *max) : QuantParams()});
+    }
+
+    // Symmetric quantization with one scale per slice along axis, as used for weights
+    static QuantizedTensor QuantizePerChannel(const Tensor& tensor, size_t axis = 0) {
+        if (axis >= tensor.shape().size()) throw std::invalid_argument("Quantization axis is out of range");
+        std::vector<float> max_abs(tensor.shape(axis), 0.0f);
+        const size_t inner = SliceStride(tensor.shape(), axis);
+        for (size_t i = 0; i < tensor.size(); ++i) {
+            float& channel = max_abs[i / inner % max_abs.size()];
+            channel = std::max(channel, std::fabs(tensor.data()[i]));
+        }
+        std::vector<QuantParams> params;
+        for (float value : max_abs) params.push_back(QuantParams::Symmetric(value));
+        return Quantize(tensor, std::move(params), axis);
+    }
+
+    Tensor Dequantize() const {
+        Tensor result(shape_, Tensor::Uninitialized());
+        for (size_t i = 0; i < size(); ++i) result.data()[i] = paramsAt(i).Dequantize(data_[i]);
+        return result;
+    }
+
+    const std::vector<size_t>& shape() const { return shape_; }
+    size_t size() const { return data_.size(); }
+    size_t axis() const { return axis_; }
+    bool perChannel() const { return axis_ != kPerTensor; }
+    const std::vector<QuantParams>& params() const { return params_; }
+
+    int8_t* data() { return data_.data(); }
+    const int8_t* data() const { return data_.data(); }
+
+    // Parameters of flat element i
+    const QuantParams& paramsAt(size_t i) const {
+        if (axis_ == kPerTensor) return params_.front();
+        return params_[i / SliceStride(shape_, axis_) % shape_[axis_]];
+    }
+
+private:
+    std::vector<size_t> shape_;
+    std::vector<int8_t> data_;
+    std::vector<QuantParams> params_;
+    size_t axis_ = kPerTensor;
+
+    // Elements between consecutive indices of axis
+    static size_t SliceStride(const std::vector<size_t>& shape, size_t axis) {
+        size_t stride = 1;
+        for (size_t d = axis + 1; d < shape.size(); ++d) stride *= shape[d];
+        return stride;
+    }
+};
+
+
+// Operation with an int8 path, taken once it knows how its activations
+// (the lhs operand) are quantized, e.g. from a Calibrator
+class Quantizable {
+public:
+    virtual ~Quantizable() = default;
+
+    void setQuantization(const QuantParams& activation) { quantization_ = activation; }
+
+    void clearQuantization() { quantization_.reset(); }
+
+    const std::optional<QuantParams>& getQuantization() const { return quantization_; }
+
+protected:
+    std::optional<QuantParams> quantization_;
+};
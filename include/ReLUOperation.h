@@ -7,18 +7,23 @@ public:
     ReLUOperation(const std::shared_ptr<INode> arg): UnaryOperation(arg) {}
     ReLUOperation(const Tensor& tensor): UnaryOperation(tensor) {}
 
-    Tensor evaluate() const override {
-        Tensor input;
-        if(is_node_) input = arg_->evaluate();
-        else input = tensor_;
-
-        Tensor output(input.shape());
-        
-        // ReLU: max(0, x)
-        for (size_t i = 0; i < input.size(); ++i) {
-            output.at(i) = std::max(0.0f, input.at(i));
-        }
-        
-        return output;
+    using UnaryOperation::compute;
+
+    OpKind kind() const override { return OpKind::ReLU; }
+
+    bool supportsLayout(Layout) const override { return true; }
+
+    bool computesInPlace() const override { return true; }
+
+    Layout preferredLayout(const std::vector<Layout>& arg_layouts, const std::vector<std::vector<size_t>>&, Layout) const override {
+        return arg_layouts.empty() ? Layout::NCHW : arg_layouts.front();
+    }
+
+    void compute(const Tensor& input, Tensor& output) const override {
+        checkLayout(input);
+        Tensor scratch;
+        const Tensor& in = inLayout(input, output.layout(), scratch);
+        // ReLU: max(0, x), padding lanes stay zero
+        Elementwise::Relu(in.data(), output.data(), output.size());
     }
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "Operations.h"
+
+#pragma once
+
+// Copies its input into another storage layout. LayoutAssignment inserts these
+// where a producer and a consumer disagree on the layout.
+class ReorderOperation : public UnaryOperation {
+public:
+    ReorderOperation(const std::shared_ptr<INode> arg, Layout layout): UnaryOperation(arg), layout_(layout) {}
+    ReorderOperation(const Tensor& tensor, Layout layout): UnaryOperation(tensor), layout_(layout) {}
+
+    using UnaryOperation::compute;
+
+    OpKind kind() const override { return OpKind::Reorder; }
+
+    // Target layout
+    Layout layout() const { return layout_; }
+
+    bool supportsLayout(Layout) const override { return true; }
+
+    Layout preferredLayout(const std::vector<Layout>&, const std::vector<std::vector<size_t>>&, Layout) const override {
+        return layout_;
+    }
+
+    Layout outputLayout(Layout) const override { return layout_; }
+
+    // bf16/f16 inputs (e.g. a 16-bit graph input) come out as f32
+    bool readsHalf() const override { return true; }
+
+    void compute(const Tensor& input, Tensor& output) const override {
+        if (input.shape() != output.shape()) throw std::invalid_argument("Reorder keeps the shape");
+        Tensor scratch;
+        const Tensor& in = inFloat(input, scratch);
+        Reorder(in.data(), in.layout(), output.data(), output.layout(), in.shape());
+    }
+
+private:
+    Layout layout_;
+};
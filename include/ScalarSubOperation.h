@@ -5,20 +5,28 @@
 class ScalarSubOperation : public BinaryOperation {
 public:
     ScalarSubOperation(const std::shared_ptr<INode> lhs, const std::shared_ptr<INode> rhs): BinaryOperation(lhs, rhs) {}
-    ScalarSubOperation(const std::shared_ptr<INode> lhs, const Tensor& rhs_tensor): BinaryOperation(lhs, rhs_tensor) {}
-    ScalarSubOperation(const Tensor& lhs_tensor, const std::shared_ptr<INode> rhs): BinaryOperation(lhs_tensor, rhs) {}
-    ScalarSubOperation(const Tensor& lhs_tensor, const Tensor& rhs_tensor): BinaryOperation(lhs_tensor, rhs_tensor) {}
-
-    Tensor evaluate() const override {
-        Tensor lhs_tensor;
-        Tensor rhs_tensor;
-        
-        if(lhs_is_node_) lhs_tensor = lhs_->evaluate();
-        else lhs_tensor = lhs_tensor_;
-        if(rhs_is_node_) rhs_tensor = rhs_->evaluate();
-        else rhs_tensor = rhs_tensor_;
-
-        if(lhs_tensor.shape() != rhs_tensor.shape()) throw std::invalid_argument("Shapes must match for subtraction.");
-        return lhs_tensor - rhs_tensor;
+    ScalarSubOperation(const std::shared_ptr<INode> lhs, Tensor rhs_tensor): BinaryOperation(lhs, std::move(rhs_tensor)) {}
+    ScalarSubOperation(Tensor lhs_tensor, const std::shared_ptr<INode> rhs): BinaryOperation(std::move(lhs_tensor), rhs) {}
+    ScalarSubOperation(Tensor lhs_tensor, Tensor rhs_tensor): BinaryOperation(std::move(lhs_tensor), std::move(rhs_tensor)) {}
+
+    using BinaryOperation::compute;
+
+    OpKind kind() const override { return OpKind::Sub; }
+
+    bool supportsLayout(Layout) const override { return true; }
+
+    bool computesInPlace() const override { return true; }
+
+    Layout preferredLayout(const std::vector<Layout>& arg_layouts, const std::vector<std::vector<size_t>>& arg_shapes, Layout) const override {
+        return elementwiseLayout(arg_layouts, arg_shapes);
+    }
+
+    std::vector<size_t> outputShape(const std::vector<size_t>& lhs_shape, const std::vector<size_t>& rhs_shape) const override {
+        return BroadcastShape(lhs_shape, rhs_shape, "Shapes cannot be broadcast for subtraction.");
+    }
+
+    void compute(const Tensor& lhs_tensor, const Tensor& rhs_tensor, Tensor& output) const override {
+        outputShape(lhs_tensor.shape(), rhs_tensor.shape());
+        elementwise(ElementwiseOp::Sub, lhs_tensor, rhs_tensor, output);
     }
 };
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include <array>
+#include <cstddef>
+#include <utility>
+#include "GemmEpilogue.h"
+
+#pragma once
+
+// Kernels for small column-major GEMMs C(n x m) = A(n x k) * B(k x m) with n, m
+// and k template parameters, instantiated for every combination of kSizes. They
+// read A and B in place (unit row strides, any leading dimension) and keep C in
+// registers, skipping the packing buffers and edge-tile copies BlockedGemm
+// spends more time on than the arithmetic at these sizes.
+// Kernel provides Supports<N>() and Run<N, M, K>(A, lda, B, ldb, C, ldc, epilogue).
+template <typename Kernel>
+class SmallGemm {
+public:
+    using Function = void (*)(const float *, size_t, const float *, size_t, float *, size_t, const GemmEpilogue *);
+
+    static constexpr std::array<size_t, 4> kSizes = {8, 16, 32, 64};
+
+    // Kernel for the shape, nullptr when it is not in the precompiled set
+    static Function Find(size_t n, size_t m, size_t k) {
+        static constexpr std::array<Function, kCount> table = MakeTable(std::make_index_sequence<kCount>());
+        const size_t i = SizeIndex(n), j = SizeIndex(m), p = SizeIndex(k);
+        if (i == kSizes.size() || j == kSizes.size() || p == kSizes.size()) return nullptr;
+        return table[(i * kSizes.size() + j) * kSizes.size() + p];
+    }
+
+private:
+    static constexpr size_t kCount = kSizes.size() * kSizes.size() * kSizes.size();
+
+    static size_t SizeIndex(size_t size) {
+        size_t index = 0;
+        while (index < kSizes.size() && kSizes[index] != size) ++index;
+        return index;
+    }
+
+    template <size_t... I>
+    static constexpr std::array<Function, kCount> MakeTable(std::index_sequence<I...>) {
+        return {Entry<I>()...};
+    }
+
+    template <size_t I>
+    static constexpr Function Entry() {
+        constexpr size_t S = kSizes.size();
+        constexpr size_t N = kSizes[I / (S * S)], M = kSizes[I / S % S], K = kSizes[I % S];
+        if constexpr (Kernel::template Supports<N>()) return &Kernel::template Run<N, M, K>;
+        else return nullptr;
+    }
+};
@@ -0,0 +1,65 @@
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+#include "GemmEpilogue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX-512F shape-specialized kernel, see SmallGemm.h. Each block of J columns
+// of C stays in N / 16 x J registers for the whole depth, A's column of N rows
+// is loaded once per depth step and reused across the J columns, and the
+// register tile is unrolled at compile time. At most 24 accumulators of 32 zmm.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class SmallGemmKernelAvx512 {
+public:
+    static constexpr size_t kLanes = 16;
+    static constexpr size_t kAccumulators = 24;
+
+    template <size_t N>
+    static constexpr bool Supports() { return N % kLanes == 0 && N / kLanes <= kAccumulators; }
+
+    template <size_t N, size_t M, size_t K>
+    __attribute__((target("avx512f")))
+    static void Run(const float *A, size_t lda, const float *B, size_t ldb, float *C, size_t ldc,
+                    const GemmEpilogue *epilogue) {
+        static_assert(Supports<N>());
+        constexpr size_t R = N / kLanes;
+        constexpr size_t J = std::min(M, std::bit_floor(kAccumulators / R));
+        static_assert(M % J == 0, "Column count must split into whole register blocks");
+
+        for (size_t j0 = 0; j0 < M; j0 += J) {
+            __m512 acc[J][R];
+            for (size_t j = 0; j < J; ++j)
+                for (size_t r = 0; r < R; ++r) acc[j][r] = _mm512_setzero_ps();
+
+            for (size_t p = 0; p < K; ++p) {
+                __m512 a[R];
+                for (size_t r = 0; r < R; ++r) a[r] = _mm512_loadu_ps(A + p * lda + r * kLanes);
+                for (size_t j = 0; j < J; ++j) {
+                    const __m512 b = _mm512_set1_ps(B[p + (j0 + j) * ldb]);
+                    for (size_t r = 0; r < R; ++r) acc[j][r] = _mm512_fmadd_ps(a[r], b, acc[j][r]);
+                }
+            }
+
+            for (size_t j = 0; j < J; ++j) {
+                float *c = C + (j0 + j) * ldc;
+                for (size_t r = 0; r < R; ++r) {
+                    if (epilogue && epilogue->addend) {
+                        const float *d = epilogue->addend + (j0 + j) * epilogue->ld_addend;
+                        acc[j][r] = _mm512_add_ps(acc[j][r], epilogue->rs_addend == 0 ? _mm512_set1_ps(*d) : _mm512_loadu_ps(d + r * kLanes));
+                    }
+                    if (epilogue && epilogue->relu) acc[j][r] = _mm512_max_ps(acc[j][r], _mm512_setzero_ps());
+                    _mm512_storeu_ps(c + r * kLanes, acc[j][r]);
+                }
+            }
+        }
+    }
+};
+
+#endif
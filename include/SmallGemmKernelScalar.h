@@ -0,0 +1,25 @@
+#include <cstddef>
+#include "GemmEpilogue.h"
+
+#pragma once
+
+// Portable shape-specialized kernel, see SmallGemm.h. With every trip count a
+// compile-time constant the compiler unrolls and vectorizes for the baseline ISA.
+class SmallGemmKernelScalar {
+public:
+    template <size_t N>
+    static constexpr bool Supports() { return true; }
+
+    template <size_t N, size_t M, size_t K>
+    static void Run(const float *A, size_t lda, const float *B, size_t ldb, float *C, size_t ldc,
+                    const GemmEpilogue *epilogue) {
+        for (size_t j = 0; j < M; ++j) {
+            float acc[N] = {};
+            for (size_t p = 0; p < K; ++p) {
+                const float b = B[p + j * ldb];
+                for (size_t i = 0; i < N; ++i) acc[i] += A[i + p * lda] * b;
+            }
+            for (size_t i = 0; i < N; ++i) C[i + j * ldc] = epilogue ? epilogue->Apply(acc[i], i, j) : acc[i];
+        }
+    }
+};
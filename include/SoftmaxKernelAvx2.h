@@ -0,0 +1,101 @@
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2 + FMA softmax row kernel, the 8-lane counterpart of SoftmaxKernelAvx512.
+// 2^n is built in the exponent bits, which the argument clamp keeps in range.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class SoftmaxKernelAvx2 {
+public:
+    static constexpr size_t kLanes = 8;
+
+    __attribute__((target("avx2,fma")))
+    static void Run(const float *in, float *out, size_t n) {
+        __m256 max = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+        __m256 sum = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            const __m256 x = _mm256_loadu_ps(in + i);
+            const __m256 new_max = _mm256_max_ps(max, x);
+            sum = _mm256_fmadd_ps(sum, Exp(_mm256_sub_ps(max, new_max)), Exp(_mm256_sub_ps(x, new_max)));
+            max = new_max;
+        }
+        const __m256i tail = TailMask(n - i);
+        if (i < n) {
+            const __m256 loaded = _mm256_castsi256_ps(tail);
+            const __m256 x = _mm256_maskload_ps(in + i, tail);
+            const __m256 new_max = _mm256_blendv_ps(max, _mm256_max_ps(max, x), loaded);
+            const __m256 e = _mm256_and_ps(Exp(_mm256_sub_ps(x, new_max)), loaded);
+            sum = _mm256_fmadd_ps(sum, Exp(_mm256_sub_ps(max, new_max)), e);
+            max = new_max;
+        }
+
+        // Lanes that saw no element hold sum 0 and drop out of the merge
+        const __m256 row_max = _mm256_set1_ps(ReduceMax(max));
+        const float row_sum = ReduceAdd(_mm256_mul_ps(sum, Exp(_mm256_sub_ps(max, row_max))));
+        const __m256 inverse = _mm256_set1_ps(1.0f / row_sum);
+
+        for (i = 0; i + kLanes <= n; i += kLanes)
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(Exp(_mm256_sub_ps(_mm256_loadu_ps(in + i), row_max)), inverse));
+        if (i < n) {
+            const __m256 x = _mm256_maskload_ps(in + i, tail);
+            _mm256_maskstore_ps(out + i, tail, _mm256_mul_ps(Exp(_mm256_sub_ps(x, row_max)), inverse));
+        }
+    }
+
+private:
+    // All ones in the first count lanes
+    __attribute__((target("avx2,fma")))
+    static __m256i TailMask(size_t count) {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(count)), lanes);
+    }
+
+    __attribute__((target("avx2,fma")))
+    static float ReduceMax(__m256 v) {
+        __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        return _mm_cvtss_f32(m);
+    }
+
+    __attribute__((target("avx2,fma")))
+    static float ReduceAdd(__m256 v) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+
+    // Same reduction and polynomial as SoftmaxKernelAvx512::Exp
+    __attribute__((target("avx2,fma")))
+    static __m256 Exp(__m256 x) {
+        x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(88.3762626647949f)), _mm256_set1_ps(-87.3365478515625f));
+        const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                         _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+        r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+
+        __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+        p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+        // 2^n from the exponent field; n is in [-126, 127] after the clamp
+        const __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+        return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+    }
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include <cstddef>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX-512F softmax row kernel, see SoftmaxKernelScalar.h for the recurrence.
+// Every lane keeps its own running max and sum, merged once at the end of the
+// row; the tail is handled with masked loads and stores. exp is a degree-6
+// polynomial on the reduced argument, scaled by 2^n with vscalefps.
+// Compiled with a target attribute so the rest of the binary stays baseline x86-64.
+class SoftmaxKernelAvx512 {
+public:
+    static constexpr size_t kLanes = 16;
+
+    __attribute__((target("avx512f")))
+    static void Run(const float *in, float *out, size_t n) {
+        __m512 max = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+        __m512 sum = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            const __m512 x = _mm512_loadu_ps(in + i);
+            const __m512 new_max = _mm512_max_ps(max, x);
+            sum = _mm512_fmadd_ps(sum, Exp(_mm512_sub_ps(max, new_max)), Exp(_mm512_sub_ps(x, new_max)));
+            max = new_max;
+        }
+        const __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+        if (tail) {
+            const __m512 x = _mm512_maskz_loadu_ps(tail, in + i);
+            const __m512 new_max = _mm512_mask_max_ps(max, tail, max, x);
+            const __m512 e = _mm512_maskz_mov_ps(tail, Exp(_mm512_sub_ps(x, new_max)));
+            sum = _mm512_fmadd_ps(sum, Exp(_mm512_sub_ps(max, new_max)), e);
+            max = new_max;
+        }
+
+        // Lanes that saw no element hold sum 0 and drop out of the merge
+        const __m512 row_max = _mm512_set1_ps(_mm512_reduce_max_ps(max));
+        const float row_sum = _mm512_reduce_add_ps(_mm512_mul_ps(sum, Exp(_mm512_sub_ps(max, row_max))));
+        const __m512 inverse = _mm512_set1_ps(1.0f / row_sum);
+
+        for (i = 0; i + kLanes <= n; i += kLanes)
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(Exp(_mm512_sub_ps(_mm512_loadu_ps(in + i), row_max)), inverse));
+        if (tail) {
+            const __m512 x = _mm512_maskz_loadu_ps(tail, in + i);
+            _mm512_mask_storeu_ps(out + i, tail, _mm512_mul_ps(Exp(_mm512_sub_ps(x, row_max)), inverse));
+        }
+    }
+
+private:
+    // exp(x) = 2^n * exp(r) with n = round(x / ln 2), |r| <= ln 2 / 2; arguments
+    // below -87.3 flush to ~0, which is all softmax needs since x <= max
+    __attribute__((target("avx512f")))
+    static __m512 Exp(__m512 x) {
+        x = _mm512_max_ps(_mm512_min_ps(x, _mm512_set1_ps(88.3762626647949f)), _mm512_set1_ps(-87.3365478515625f));
+        const __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)),
+                                              _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+        r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), r);
+
+        __m512 p = _mm512_set1_ps(1.9875691500e-4f);
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+        p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+        return _mm512_scalef_ps(p, n);
+    }
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
+#pragma once
+
+// Portable softmax row kernel, see SoftmaxOperation.h. One pass keeps the
+// running max m and the running sum s of exp(x - m), rescaling s whenever the
+// max grows; a second pass writes exp(x - m) / s. Subtracting the max keeps
+// large logits from overflowing.
+class SoftmaxKernelScalar {
+public:
+    static void Run(const float *in, float *out, size_t n) {
+        float max = std::numeric_limits<float>::lowest();
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            if (in[i] > max) {
+                sum = sum * std::exp(max - in[i]) + 1.0f;
+                max = in[i];
+            } else {
+                sum += std::exp(in[i] - max);
+            }
+        }
+        const float inverse = 1.0f / sum;
+        for (size_t i = 0; i < n; ++i) out[i] = std::exp(in[i] - max) * inverse;
+    }
+};
@@ -1,46 +1,68 @@
 #include "Operations.h"
+#include "FastMatMul.h"
+#include "SoftmaxKernelScalar.h"
+#include "SoftmaxKernelAvx2.h"
+#include "SoftmaxKernelAvx512.h"
 
 #pragma once
 
 
+// Softmax over every dimension from axis on: the tensor is read as rows of
+// shape[axis] * ... * shape[rank - 1] contiguous elements, each normalized on
+// its own. The default axis 2 normalizes each H x W plane per (batch, channel);
+// axis 3 normalizes the last dimension only, as classification heads need.
 class SoftmaxOperation : public UnaryOperation {
 public:
-    SoftmaxOperation(const std::shared_ptr<INode> arg): UnaryOperation(arg) {}
-    SoftmaxOperation(const Tensor& tensor): UnaryOperation(tensor) {}
-
-    Tensor evaluate() const override {
-        Tensor input;
-        if(is_node_) input = arg_->evaluate();
-        else input = tensor_;
-        
-        std::vector<size_t> output_shape = input.shape();
-        Tensor output(output_shape);
-        
-        size_t batch_size = input.shape()[0];
-        size_t channels = input.shape()[1];
-        size_t height = input.shape()[2];
-        size_t width = input.shape()[3];
-        
-        for (size_t b = 0; b < batch_size; ++b) {
-            for (size_t c = 0; c < channels; ++c) {
-                std::vector<float> exp_values(width * height);
-                float exp_sum = 0.0f;
-
-                for (size_t h = 0; h < height; ++h) {
-                    for (size_t w = 0; w < width; ++w) {
-                        exp_values[w + h * width] = std::exp(input.at(b, c, h, w));
-                        exp_sum += exp_values[w + h * width];
-                    }
-                }
-
-                for (size_t h = 0; h < height; ++h) {
-                    for (size_t w = 0; w < width; ++w) {
-                        output.at(b, c, h, w) = exp_values[w + h * width] / exp_sum;
-                    }
-                }
-            }
+    SoftmaxOperation(const std::shared_ptr<INode> arg, size_t axis = 2): UnaryOperation(arg), axis_(axis) {}
+    SoftmaxOperation(const Tensor& tensor, size_t axis = 2): UnaryOperation(tensor), axis_(axis) {}
+
+    using UnaryOperation::compute;
+
+    OpKind kind() const override { return OpKind::Softmax; }
+
+    size_t getAxis() const { return axis_; }
+
+    std::vector<size_t> outputShape(const std::vector<size_t>& input_shape) const override {
+        if (axis_ >= input_shape.size()) throw std::invalid_argument("Softmax axis is out of range");
+        return input_shape;
+    }
+
+    void compute(const Tensor& input, Tensor& output) const override {
+        checkLayout(input);
+        checkLayout(output);
+        const std::vector<size_t>& shape = outputShape(input.shape());
+        size_t row_size = 1;
+        for (size_t d = axis_; d < shape.size(); ++d) row_size *= shape[d];
+        if (row_size == 0) return;
+        const size_t rows = input.size() / row_size;
+
+        // Short rows are grouped so every task has enough work to pay for scheduling
+        const size_t rows_per_task = std::max<size_t>(1, kTaskElements / row_size);
+        const size_t tasks = (rows + rows_per_task - 1) / rows_per_task;
+        void (*kernel)(const float*, float*, size_t) = Kernel();
+        const float* in = input.data();
+        float* out = output.data();
+        ThreadPool::Shared().ParallelFor(tasks, [&](size_t task) {
+            const size_t end = std::min(rows, (task + 1) * rows_per_task);
+            for (size_t row = task * rows_per_task; row < end; ++row) kernel(in + row * row_size, out + row * row_size, row_size);
+        }, FastMatMul::GetNumThreads());
+    }
+
+private:
+    static constexpr size_t kTaskElements = 4096;
+
+    size_t axis_;
+
+    // Kernel for the ISA of the active GEMM backend, so forcing a backend also
+    // picks the softmax kernel
+    static void (*Kernel())(const float*, float*, size_t) {
+#if defined(__x86_64__) || defined(__i386__)
+        switch (FastMatMul::GetBackend()) {
+            case GemmBackend::Avx512: return &SoftmaxKernelAvx512::Run;
+            case GemmBackend::Avx2:   return &SoftmaxKernelAvx2::Run;
+            default:                  break;
         }
-        
-        return output;
+#endif
+        return &SoftmaxKernelScalar::Run;
     }
 };
@@ -4,50 +4,144 @@
 #include <stdexcept>
 #include <memory>
 #include <math.h>
+#include <algorithm>
+#include "Allocator.h"
+#include "Layout.h"
+#include "Elementwise.h"
+#include "DType.h"
+#include "HalfConvert.h"
 
 #pragma once
 
 //template<typename T>
 class Tensor {
 private:
-    // NCHW: [batch, channels, height, width]
+    // NCHW: [batch, channels, height, width], whatever the storage layout
     std::vector<size_t> shape_;
-    std::vector<float> data_;
+    Layout layout_ = Layout::NCHW;
+    DType dtype_ = DType::F32;
+    void* data_ = nullptr;            // first element, owned or in an external buffer
+    size_t size_ = 0;                 // stored elements, see StorageSize
+    Allocator* allocator_ = nullptr;  // owner of data_, nullptr for external tensors
+
+    static size_t count(const std::vector<size_t>& shape) {
+        size_t size = 1;
+        for (size_t dim : shape) size *= dim;
+        return size;
+    }
+
+    // Owned, uninitialized storage for size elements
+    void allocate(size_t size, Allocator* allocator) {
+        release();
+        size_ = size;
+        if (size == 0) return;
+        allocator_ = allocator;
+        data_ = allocator_->Allocate(size * DTypeSize(dtype_));
+    }
+
+    void release() {
+        if (allocator_ && data_) allocator_->Deallocate(data_, size_ * DTypeSize(dtype_));
+        data_ = nullptr;
+        size_ = 0;
+        allocator_ = nullptr;
+    }
+
+    // dtype_ must already be other's
+    void copy_from(const Tensor& other) {
+        // An owned buffer of the right size is reused
+        if (!allocator_ || size_ != other.size_) allocate(other.size_, other.allocator_ ? other.allocator_ : Allocator::Default());
+        if (size_) std::memcpy(data_, other.data_, size_ * DTypeSize(dtype_));
+    }
+
+    float* floats() const {
+        assert(dtype_ == DType::F32);
+        return static_cast<float*>(data_);
+    }
 
 public:
+    // Tag for constructors that leave the elements unset, for outputs a kernel overwrites entirely
+    struct Uninitialized {};
+
     // Default
-    Tensor() : shape_({0, 0, 0, 0}), data_() {}
+    Tensor() : shape_({0, 0, 0, 0}) {}
 
     // With shape parameters
     Tensor(size_t batch, size_t channels, size_t height, size_t width): shape_({batch, channels, height, width}) {
-        data_.resize(batch * channels * height * width, 0.0f); // preserve memory
+        allocate(count(shape_), Allocator::Default());
+        std::fill(floats(), floats() + size_, 0.0f); // preserve memory
     }
 
     // With shape and initial
     Tensor(const std::vector<size_t>& shape, const std::vector<float>& data = {}): shape_(shape) {
-        size_t size = 1;
-        for (size_t dim : shape_) {
-            size *= dim;
-        }
-        if (data.empty()) {
-            data_.resize(size, 0.0f);
-        } else {
-            if(data.size() != size) throw std::length_error("Data size must match tensor size");
-            data_ = data;
-        }
+        const size_t size = count(shape_);
+        if (!data.empty() && data.size() != size) throw std::length_error("Data size must match tensor size");
+        allocate(size, Allocator::Default());
+        if (data.empty()) std::fill(floats(), floats() + size_, 0.0f);
+        else std::copy(data.begin(), data.end(), floats());
+    }
+
+    // With shape, elements left unset; storage from the given allocator
+    Tensor(const std::vector<size_t>& shape, Uninitialized, Allocator* allocator = Allocator::Default()): shape_(shape) {
+        allocate(count(shape_), allocator);
+    }
+
+    // With shape, stored in the given layout, elements left unset
+    Tensor(const std::vector<size_t>& shape, Layout layout, Uninitialized, Allocator* allocator = Allocator::Default())
+        : shape_(shape), layout_(layout) {
+        allocate(StorageSize(shape_, layout_), allocator);
+    }
+
+    // With shape, NCHW elements of dtype left unset
+    Tensor(const std::vector<size_t>& shape, DType dtype, Uninitialized, Allocator* allocator = Allocator::Default())
+        : shape_(shape), dtype_(dtype) {
+        allocate(count(shape_), allocator);
+    }
+
+    // Non-owning tensor over caller memory (e.g. a planned arena slot), which
+    // must outlive it. Copies of it own their data again.
+    static Tensor Wrap(const std::vector<size_t>& shape, float* data, Layout layout = Layout::NCHW) {
+        Tensor tensor;
+        tensor.shape_ = shape;
+        tensor.layout_ = layout;
+        tensor.size_ = StorageSize(shape, layout);
+        tensor.data_ = data;
+        return tensor;
+    }
+
+    // Non-owning tensor of any dtype, e.g. over weights in a mapped model file
+    static Tensor Wrap(const std::vector<size_t>& shape, DType dtype, void* data, Layout layout = Layout::NCHW) {
+        Tensor tensor;
+        tensor.shape_ = shape;
+        tensor.layout_ = layout;
+        tensor.dtype_ = dtype;
+        tensor.size_ = StorageSize(shape, layout);
+        tensor.data_ = data;
+        return tensor;
     }
 
+    ~Tensor() { release(); }
+
     // Copy ctor
-    Tensor(const Tensor& other) : shape_(other.shape_), data_(other.data_) {}
+    Tensor(const Tensor& other) : shape_(other.shape_), layout_(other.layout_), dtype_(other.dtype_) {
+        copy_from(other);
+    }
 
     // Move ctor
-    Tensor(Tensor&& other) noexcept: shape_(std::move(other.shape_)), data_(std::move(other.data_)) {}
+    Tensor(Tensor&& other) noexcept
+        : shape_(std::move(other.shape_)), layout_(other.layout_), dtype_(other.dtype_), data_(other.data_), size_(other.size_), allocator_(other.allocator_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.allocator_ = nullptr;
+    }
 
     // Copy assignment
     Tensor& operator=(const Tensor& other) {
         if (this != &other) {
+            if (dtype_ != other.dtype_) release();
             shape_ = other.shape_;
-            data_ = other.data_;
+            layout_ = other.layout_;
+            dtype_ = other.dtype_;
+            copy_from(other);
         }
         return *this;
     }
@@ -55,15 +149,60 @@ public:
     // Move assignment
     Tensor& operator=(Tensor&& other) noexcept {
         if (this != &other) {
+            release();
             shape_ = std::move(other.shape_);
-            data_ = std::move(other.data_);
+            layout_ = other.layout_;
+            dtype_ = other.dtype_;
+            data_ = other.data_;
+            size_ = other.size_;
+            allocator_ = other.allocator_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.allocator_ = nullptr;
         }
         return *this;
     }
 
+    // Allocator owning the elements, nullptr for external or empty tensors
+    Allocator* allocator() const { return allocator_; }
+
+    // Whether the elements live in memory this tensor does not own
+    bool is_external() const { return data_ != nullptr && allocator_ == nullptr; }
+
+    // Storage order of the elements
+    Layout layout() const { return layout_; }
+
+    // Element type of the storage; kernels read f32 tensors through data()
+    DType dtype() const { return dtype_; }
+
+    // Copy stored in another layout
+    Tensor toLayout(Layout layout) const {
+        if (layout == layout_) return *this;
+        if (dtype_ != DType::F32) throw std::invalid_argument("Only f32 tensors can be reordered");
+        Tensor result(shape_, layout, Uninitialized(), allocator_ ? allocator_ : Allocator::Default());
+        Reorder(floats(), layout_, result.floats(), layout, shape_);
+        return result;
+    }
+
+    // Copy with elements of another type, rounded to nearest even when narrowing
+    Tensor toDType(DType dtype) const {
+        if (dtype == dtype_) return *this;
+        Tensor result;
+        result.shape_ = shape_;
+        result.layout_ = layout_;
+        result.dtype_ = dtype;
+        result.allocate(size_, allocator_ ? allocator_ : Allocator::Default());
+        if (dtype_ == DType::F32) HalfConvert::FromFloat(dtype, floats(), result.halfData(), size_);
+        else if (dtype == DType::F32) HalfConvert::ToFloat(dtype_, halfData(), result.floats(), size_);
+        else return toDType(DType::F32).toDType(dtype);
+        return result;
+    }
+
     // Calculate index
     size_t index(size_t n, size_t c, size_t h, size_t w) const {
         if(n > shape_[0] || c > shape_[1] || h > shape_[2] || w > shape_[3]) throw std::out_of_range("Index out of range");
+        if (layout_ != Layout::NCHW)
+            return PlaneOffset(shape_, layout_, n, c) + (h * shape_[3] + w) * PixelStride(shape_, layout_);
         return n * (shape_[1] * shape_[2] * shape_[3]) + c * (shape_[2] * shape_[3]) + h * shape_[3] + w;
     }
 
@@ -78,13 +217,9 @@ public:
         return shape_[dim];
     }
 
-    // Get total number of elements
+    // Get total number of elements; blocked layouts also count their channel padding
     size_t size() const {
-        size_t total = 1;
-        for (size_t dim : shape_) {
-            total *= dim;
-        }
-        return total;
+        return size_;
     }
 
     // Reshape tensor (total size must remain the same)
@@ -93,6 +228,7 @@ public:
         for (size_t dim : new_shape) {
             new_size *= dim;
         }
+        if (layout_ != Layout::NCHW) throw std::invalid_argument("Only NCHW tensors can be reshaped");
         if(new_size != size()) throw std::length_error("New shape must have the same total size");
         shape_ = new_shape;
     }
@@ -100,35 +236,47 @@ public:
 
     // Access element
     float& at(size_t n, size_t c, size_t h, size_t w) {
-        return data_[index(n, c, h, w)];
+        return floats()[index(n, c, h, w)];
     }
 
     // Access element const
     const float& at(size_t n, size_t c, size_t h, size_t w) const {
-        return data_[index(n, c, h, w)];
+        return floats()[index(n, c, h, w)];
     }
 
     // Access element flat
     float& at(size_t idx) {
-        if(idx > data_.size()) throw std::out_of_range("Index out of range");
-        return data_[idx];
+        if(idx > size_) throw std::out_of_range("Index out of range");
+        return floats()[idx];
     }
 
     // Access element flat const
     const float& at(size_t idx) const {
-        if(idx > data_.size()) throw std::out_of_range("Index out of range");
-        return data_[idx];
+        if(idx > size_) throw std::out_of_range("Index out of range");
+        return floats()[idx];
     }
 
     // Get all tensor to compare
-    std::vector<float> GetData() { return data_; }
+    std::vector<float> GetData() { return std::vector<float>(floats(), floats() + size_); }
+
+    // Raw contiguous storage in layout() order, for kernels; f32 tensors only
+    float* data() { return floats(); }
+    const float* data() const { return floats(); }
+
+    // Raw storage of a bf16 or f16 tensor
+    uint16_t* halfData() {
+        assert(dtype_ != DType::F32);
+        return static_cast<uint16_t*>(data_);
+    }
+    const uint16_t* halfData() const {
+        assert(dtype_ != DType::F32);
+        return static_cast<const uint16_t*>(data_);
+    }
 
     // Tensor addition
     Tensor& operator+=(const Tensor& other) {
-        if(shape_ != other.shape_) throw std::length_error("Tensors must have the same shape");
-        for (size_t i = 0; i < data_.size(); ++i) {
-            data_[i] += other.data_[i];
-        }
+        if(shape_ != other.shape_ || layout_ != other.layout_) throw std::length_error("Tensors must have the same shape and layout");
+        Elementwise::Binary(ElementwiseOp::Add, data(), other.data(), data(), size_);
         return *this;
     }
     
@@ -140,10 +288,8 @@ public:
 
     // Tensor subtraction
     Tensor& operator-=(const Tensor& other) {
-        if(shape_ != other.shape_) throw std::length_error("Tensors must have the same shape");
-        for (size_t i = 0; i < data_.size(); ++i) {
-            data_[i] -= other.data_[i];
-        }
+        if(shape_ != other.shape_ || layout_ != other.layout_) throw std::length_error("Tensors must have the same shape and layout");
+        Elementwise::Binary(ElementwiseOp::Sub, data(), other.data(), data(), size_);
         return *this;
     }
 
@@ -155,19 +301,18 @@ public:
 
     // Scalar multiplication
     Tensor& operator*=(float scalar) {
-        for (auto& val : data_) {
-            val *= scalar;
+        float* values = data();
+        for (size_t i = 0; i < size_; ++i) {
+            values[i] *= scalar;
         }
         return *this;
     }
    
     // Element-wise multiplication
     friend Tensor elementwise_mul(const Tensor& lhs, const Tensor& rhs) {
-        if(lhs.shape_ != rhs.shape_) throw std::length_error("Tensors must have the same shape");
-        Tensor result = lhs;
-        for (size_t i = 0; i < result.data_.size(); ++i) {
-            result.data_[i] *= rhs.data_[i];
-        }
+        if(lhs.shape_ != rhs.shape_ || lhs.layout_ != rhs.layout_) throw std::length_error("Tensors must have the same shape and layout");
+        Tensor result(lhs.shape_, lhs.layout_, Uninitialized());
+        Elementwise::Binary(ElementwiseOp::Mul, lhs.data(), rhs.data(), result.data(), result.size_);
         return result;
     }
 
@@ -177,7 +322,7 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const Tensor& tensor) {
         os << "Tensor([" << tensor.shape_[0] << ", " << tensor.shape_[1] << ", " 
            << tensor.shape_[2] << ", " << tensor.shape_[3] << "], size=" 
-           << tensor.data_.size() << ")";
+           << tensor.size_ << ")";
         return os;
     }
 };
\ No newline at end of file
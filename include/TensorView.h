@@ -0,0 +1,144 @@
+#include "Tensor.h"
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+#pragma once
+
+// Non-owning window over tensor storage: shape, strides (in elements) and a first
+// element. Slicing, reshaping and transposing only rewrite that metadata, so they
+// cost O(rank) whatever the tensor size. The viewed storage must outlive the view.
+//
+// T is float for writable views and const float for read-only ones.
+template <typename T>
+class BasicTensorView {
+public:
+    BasicTensorView() = default;
+
+    BasicTensorView(T* data, const std::vector<size_t>& shape, const std::vector<size_t>& strides)
+        : data_(data), shape_(shape), strides_(strides) {
+        if (shape_.size() != strides_.size()) throw std::invalid_argument("View needs one stride per dimension");
+    }
+
+    // Whole tensor in logical NCHW order; NHWC storage becomes a strided view
+    template <typename U = T, typename = std::enable_if_t<!std::is_const_v<U>>>
+    BasicTensorView(Tensor& tensor) : BasicTensorView(tensor.data(), tensor.shape(), TensorStrides(tensor)) {}
+
+    template <typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
+    BasicTensorView(const Tensor& tensor) : BasicTensorView(tensor.data(), tensor.shape(), TensorStrides(tensor)) {}
+
+    // Writable views convert to read-only ones
+    template <typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
+    BasicTensorView(const BasicTensorView<std::remove_const_t<T>>& other)
+        : data_(other.data()), shape_(other.shape()), strides_(other.strides()) {}
+
+    T* data() const { return data_; }
+    const std::vector<size_t>& shape() const { return shape_; }
+    const std::vector<size_t>& strides() const { return strides_; }
+    size_t shape(size_t dim) const { return shape_.at(dim); }
+    size_t stride(size_t dim) const { return strides_.at(dim); }
+    size_t rank() const { return shape_.size(); }
+
+    size_t size() const {
+        size_t size = 1;
+        for (size_t dim : shape_) size *= dim;
+        return size;
+    }
+
+    // Row-major without gaps, i.e. what data() of a Tensor with this shape would hold
+    bool is_contiguous() const {
+        size_t expected = 1;
+        for (size_t d = shape_.size(); d-- > 0;) {
+            if (shape_[d] != 1 && strides_[d] != expected) return false;
+            expected *= shape_[d];
+        }
+        return true;
+    }
+
+    // Element at a full index
+    T& at(const std::vector<size_t>& index) const {
+        if (index.size() != shape_.size()) throw std::out_of_range("Index rank does not match view rank");
+        size_t offset = 0;
+        for (size_t d = 0; d < index.size(); ++d) {
+            if (index[d] >= shape_[d]) throw std::out_of_range("Index out of range");
+            offset += index[d] * strides_[d];
+        }
+        return data_[offset];
+    }
+
+    // NCHW element
+    T& at(size_t n, size_t c, size_t h, size_t w) const { return at({n, c, h, w}); }
+
+    // Entries [begin, end) of one dimension
+    BasicTensorView slice(size_t dim, size_t begin, size_t end) const {
+        if (dim >= shape_.size() || begin > end || end > shape_[dim]) throw std::out_of_range("Slice out of range");
+        BasicTensorView view = *this;
+        view.data_ += begin * strides_[dim];
+        view.shape_[dim] = end - begin;
+        return view;
+    }
+
+    // Swaps two dimensions
+    BasicTensorView transpose(size_t dim0, size_t dim1) const {
+        if (dim0 >= shape_.size() || dim1 >= shape_.size()) throw std::out_of_range("Dimension index out of range");
+        BasicTensorView view = *this;
+        std::swap(view.shape_[dim0], view.shape_[dim1]);
+        std::swap(view.strides_[dim0], view.strides_[dim1]);
+        return view;
+    }
+
+    // Same elements under a new shape; only contiguous views can be reshaped for free
+    BasicTensorView reshape(const std::vector<size_t>& new_shape) const {
+        size_t new_size = 1;
+        for (size_t dim : new_shape) new_size *= dim;
+        if (new_size != size()) throw std::length_error("New shape must have the same total size");
+        if (!is_contiguous()) throw std::invalid_argument("Only contiguous views can be reshaped");
+        return BasicTensorView(data_, new_shape, ContiguousStrides(new_shape));
+    }
+
+    // Copies the viewed elements into a new contiguous tensor
+    Tensor contiguous() const {
+        Tensor tensor(shape_);
+        float* out = tensor.data();
+        if (is_contiguous()) {
+            std::copy(data_, data_ + size(), out);
+            return tensor;
+        }
+        std::vector<size_t> index(shape_.size(), 0);
+        for (size_t i = 0, total = size(); i < total; ++i) {
+            size_t offset = 0;
+            for (size_t d = 0; d < index.size(); ++d) offset += index[d] * strides_[d];
+            out[i] = data_[offset];
+            for (size_t d = index.size(); d-- > 0;) {
+                if (++index[d] < shape_[d]) break;
+                index[d] = 0;
+            }
+        }
+        return tensor;
+    }
+
+    static std::vector<size_t> ContiguousStrides(const std::vector<size_t>& shape) {
+        std::vector<size_t> strides(shape.size(), 1);
+        for (size_t d = shape.size(); d-- > 1;) strides[d - 1] = strides[d] * shape[d];
+        return strides;
+    }
+
+private:
+    // Blocked layouts split the channel index, which no stride can express
+    static std::vector<size_t> TensorStrides(const Tensor& tensor) {
+        const std::vector<size_t>& shape = tensor.shape();
+        switch (tensor.layout()) {
+            case Layout::NCHW: return ContiguousStrides(shape);
+            case Layout::NHWC: return {shape[1] * shape[2] * shape[3], 1, shape[3] * shape[1], shape[1]};
+            default: throw std::invalid_argument("Blocked tensors cannot be viewed, reorder them first");
+        }
+    }
+
+    T* data_ = nullptr;
+    std::vector<size_t> shape_;
+    std::vector<size_t> strides_;
+};
+
+using TensorView = BasicTensorView<float>;
+using ConstTensorView = BasicTensorView<const float>;
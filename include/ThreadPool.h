@@ -0,0 +1,195 @@
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+
+#pragma once
+
+// Work-stealing pool shared by all kernels and executors of the process.
+// Every worker owns a deque: tasks submitted from a worker go to its own deque
+// (popped LIFO for locality), other tasks go to a shared injection queue, and
+// idle workers steal the oldest task of a busy one.
+// ParallelFor blocks the caller, which also takes part in the work, so nested calls
+// from inside a worker always make progress.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_workers = 0) { Start(num_workers); }
+
+    ~ThreadPool() { Stop(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool, no workers until someone asks for threads
+    static ThreadPool& Shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Number of threads a ParallelFor can use, caller included
+    size_t NumThreads() const { return workers_.size() + 1; }
+
+    // Must not be called while work is in flight
+    void Resize(size_t num_threads) {
+        const size_t num_workers = num_threads > 0 ? num_threads - 1 : 0;
+        if (num_workers == workers_.size()) return;
+        Stop();
+        Start(num_workers);
+    }
+
+    // Queues a task; without workers it runs right away on the caller
+    void Submit(std::function<void()> task) {
+        if (workers_.empty()) {
+            task();
+            return;
+        }
+        queued_++;
+        if (current_pool_ == this) {
+            Queue& own = *queues_[current_index_];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.tasks.push_back(std::move(task));
+        } else {
+            std::lock_guard<std::mutex> lock(injection_.mutex);
+            injection_.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        sleep_cv_.notify_one();
+    }
+
+    // Runs one queued task on the calling thread, if there is any
+    bool RunPendingTask() {
+        std::function<void()> task;
+        if (!Take(task)) return false;
+        task();
+        return true;
+    }
+
+    // Runs body(i) for i in [0, count) on up to max_threads threads
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body, size_t max_threads = 0) {
+        size_t threads = NumThreads();
+        if (max_threads != 0 && max_threads < threads) threads = max_threads;
+        if (threads > count) threads = count;
+
+        if (threads <= 1) {
+            for (size_t i = 0; i < count; ++i) body(i);
+            return;
+        }
+
+        // Helpers that start after every index is claimed return without touching body,
+        // so the caller only waits for indices that are actually running
+        struct Job {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex error_mutex;
+            std::exception_ptr error;
+        };
+        auto job = std::make_shared<Job>();
+
+        auto work = [job, count, &body]() {
+            for (size_t i = job->next++; i < count; i = job->next++) {
+                try {
+                    body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(job->error_mutex);
+                    if (!job->error) job->error = std::current_exception();
+                }
+                job->done++;
+            }
+        };
+
+        for (size_t t = 0; t + 1 < threads; ++t) Submit(work);
+
+        work();
+        while (job->done < count) std::this_thread::yield();
+
+        if (job->error) std::rethrow_exception(job->error);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    Queue injection_;
+    std::atomic<size_t> queued_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
+
+    static inline thread_local ThreadPool* current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+
+    void Start(size_t num_workers) {
+        stop_ = false;
+        for (size_t i = 0; i < num_workers; ++i) queues_.push_back(std::make_unique<Queue>());
+        for (size_t i = 0; i < num_workers; ++i) {
+            workers_.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (auto& worker : workers_) worker.join();
+        workers_.clear();
+        queues_.clear();
+    }
+
+    // Own deque from the back, then the injection queue, then steal from the front of others
+    bool Take(std::function<void()>& task) {
+        const bool is_worker = current_pool_ == this;
+        if (is_worker && PopBack(*queues_[current_index_], task)) return true;
+        if (PopFront(injection_, task)) return true;
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            const size_t victim = is_worker ? (current_index_ + 1 + i) % queues_.size() : i;
+            if (PopFront(*queues_[victim], task)) return true;
+        }
+        return false;
+    }
+
+    bool PopBack(Queue& queue, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        queued_--;
+        return true;
+    }
+
+    bool PopFront(Queue& queue, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued_--;
+        return true;
+    }
+
+    void WorkerLoop(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+        while (true) {
+            std::function<void()> task;
+            if (Take(task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleep_cv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+            if (stop_ && queued_ == 0) return;
+        }
+    }
+};
@@ -0,0 +1,225 @@
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "FastMatMul.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+// Transform matrices of F(M x M, 3 x 3) (Lavin & Gray, "Fast Algorithms for
+// Convolutional Neural Networks"): Y = AT [(G g GT) . (BT d B)] A
+template <size_t M>
+struct WinogradMatrices;
+
+template <>
+struct WinogradMatrices<2> {
+    static constexpr float BT[4][4] = {
+        {1.0f,  0.0f, -1.0f,  0.0f},
+        {0.0f,  1.0f,  1.0f,  0.0f},
+        {0.0f, -1.0f,  1.0f,  0.0f},
+        {0.0f,  1.0f,  0.0f, -1.0f},
+    };
+    static constexpr float G[4][3] = {
+        {1.0f,  0.0f, 0.0f},
+        {0.5f,  0.5f, 0.5f},
+        {0.5f, -0.5f, 0.5f},
+        {0.0f,  0.0f, 1.0f},
+    };
+    static constexpr float AT[2][4] = {
+        {1.0f, 1.0f,  1.0f,  0.0f},
+        {0.0f, 1.0f, -1.0f, -1.0f},
+    };
+};
+
+template <>
+struct WinogradMatrices<4> {
+    static constexpr float BT[6][6] = {
+        {4.0f,  0.0f, -5.0f,  0.0f, 1.0f, 0.0f},
+        {0.0f, -4.0f, -4.0f,  1.0f, 1.0f, 0.0f},
+        {0.0f,  4.0f, -4.0f, -1.0f, 1.0f, 0.0f},
+        {0.0f, -2.0f, -1.0f,  2.0f, 1.0f, 0.0f},
+        {0.0f,  2.0f, -1.0f, -2.0f, 1.0f, 0.0f},
+        {0.0f,  4.0f,  0.0f, -5.0f, 0.0f, 1.0f},
+    };
+    static constexpr float G[6][3] = {
+        { 1.0f / 4,   0.0f,       0.0f},
+        {-1.0f / 6,  -1.0f / 6,  -1.0f / 6},
+        {-1.0f / 6,   1.0f / 6,  -1.0f / 6},
+        { 1.0f / 24,  1.0f / 12,  1.0f / 6},
+        { 1.0f / 24, -1.0f / 12,  1.0f / 6},
+        { 0.0f,       0.0f,       1.0f},
+    };
+    static constexpr float AT[4][6] = {
+        {1.0f, 1.0f,  1.0f, 1.0f,  1.0f, 0.0f},
+        {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f},
+        {0.0f, 1.0f,  1.0f, 4.0f,  4.0f, 0.0f},
+        {0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f},
+    };
+};
+
+
+// 3x3, stride-1 convolution by Winograd minimal filtering. Every M x M output tile
+// is computed from an (M+2) x (M+2) input tile with (M+2)^2 multiplications per
+// channel pair instead of 9 M^2 (2.25x fewer for M = 2, 4x for M = 4).
+//
+// Filters and input tiles are transformed once; the elementwise products summed
+// over input channels become (M+2)^2 independent GEMMs,
+//   M[xi](out_channels x tiles) = U[xi](out_channels x in_channels) * V[xi](in_channels x tiles),
+// run as one batched GEMM; the output transform maps them back to NCHW.
+template <size_t M>
+class WinogradConv {
+public:
+    static constexpr size_t kTile = M;
+    static constexpr size_t kAlpha = M + 2;
+
+    // U[xi][oc][ic] from OIHW 3x3 weights; reusable for every input of the layer
+    static std::vector<float> TransformFilters(const float* weights, size_t out_channels, size_t in_channels) {
+        using W = WinogradMatrices<M>;
+        std::vector<float> filters(kAlpha * kAlpha * out_channels * in_channels);
+        for (size_t oc = 0; oc < out_channels; ++oc) {
+            for (size_t ic = 0; ic < in_channels; ++ic) {
+                const float* g = weights + (oc * in_channels + ic) * 9;
+                float t[kAlpha][3];
+                for (size_t i = 0; i < kAlpha; ++i)
+                    for (size_t j = 0; j < 3; ++j)
+                        t[i][j] = W::G[i][0] * g[j] + W::G[i][1] * g[3 + j] + W::G[i][2] * g[6 + j];
+                for (size_t i = 0; i < kAlpha; ++i)
+                    for (size_t j = 0; j < kAlpha; ++j)
+                        filters[((i * kAlpha + j) * out_channels + oc) * in_channels + ic] =
+                            t[i][0] * W::G[j][0] + t[i][1] * W::G[j][1] + t[i][2] * W::G[j][2];
+            }
+        }
+        return filters;
+    }
+
+    // NCHW input (batch, in_channels, height, width) -> NCHW output
+    // (batch, out_channels, height + 2 * padding - 2, width + 2 * padding - 2).
+    // addend (laid out like the output, or with per_channel one value per output
+    // channel; may be null) and relu form the fused epilogue.
+    static void Run(
+        const float* input, size_t batch, size_t in_channels, size_t height, size_t width, size_t padding,
+        const float* filters, size_t out_channels,
+        float* output, const float* addend = nullptr, bool relu = false, bool per_channel = false
+    ) {
+        const size_t out_height = height + 2 * padding - 2;
+        const size_t out_width = width + 2 * padding - 2;
+        const size_t tiles_y = (out_height + M - 1) / M;
+        const size_t tiles_x = (out_width + M - 1) / M;
+        const size_t tiles = batch * tiles_y * tiles_x;
+
+        std::vector<float> transformed_input(kAlpha * kAlpha * in_channels * tiles);
+        std::vector<float> products(kAlpha * kAlpha * out_channels * tiles);
+
+        ThreadPool& pool = ThreadPool::Shared();
+        const size_t num_threads = FastMatMul::GetNumThreads();
+
+        // V[xi][ic][tile] = BT d B
+        pool.ParallelFor(batch * in_channels, [&](size_t task) {
+            const size_t b = task / in_channels;
+            const size_t c = task % in_channels;
+            const float* image = input + (b * in_channels + c) * height * width;
+            for (size_t ty = 0; ty < tiles_y; ++ty) {
+                for (size_t tx = 0; tx < tiles_x; ++tx) {
+                    const size_t tile = (b * tiles_y + ty) * tiles_x + tx;
+                    float d[kAlpha][kAlpha];
+                    LoadTile(image, height, width, long(ty * M) - long(padding), long(tx * M) - long(padding), d);
+
+                    float v[kAlpha][kAlpha];
+                    InputTransform(d, v);
+                    for (size_t i = 0; i < kAlpha; ++i)
+                        for (size_t j = 0; j < kAlpha; ++j)
+                            transformed_input[((i * kAlpha + j) * in_channels + c) * tiles + tile] = v[i][j];
+                }
+            }
+        }, num_threads);
+
+        // One GEMM per transformed-domain position xi
+        const size_t points = kAlpha * kAlpha;
+        FastMatMul::Gemm(
+            ConstTensorView(filters, {1, points, out_channels, in_channels}, {0, out_channels * in_channels, in_channels, 1}),
+            ConstTensorView(transformed_input.data(), {1, points, in_channels, tiles}, {0, in_channels * tiles, tiles, 1}),
+            TensorView(products.data(), {1, points, out_channels, tiles}, {0, out_channels * tiles, tiles, 1})
+        );
+
+        // Y = AT m A, cropped at the right and bottom edges
+        pool.ParallelFor(batch * out_channels, [&](size_t task) {
+            const size_t b = task / out_channels;
+            const size_t oc = task % out_channels;
+            const size_t plane = (b * out_channels + oc) * out_height * out_width;
+            const float* plane_addend = !addend ? nullptr : per_channel ? addend + oc : addend + plane;
+            const size_t pixel_step = per_channel ? 0 : 1;
+            for (size_t ty = 0; ty < tiles_y; ++ty) {
+                for (size_t tx = 0; tx < tiles_x; ++tx) {
+                    const size_t tile = (b * tiles_y + ty) * tiles_x + tx;
+                    float m[kAlpha][kAlpha];
+                    for (size_t i = 0; i < kAlpha; ++i)
+                        for (size_t j = 0; j < kAlpha; ++j)
+                            m[i][j] = products[((i * kAlpha + j) * out_channels + oc) * tiles + tile];
+
+                    float y[M][M];
+                    OutputTransform(m, y);
+                    const size_t rows = std::min(M, out_height - ty * M);
+                    const size_t cols = std::min(M, out_width - tx * M);
+                    for (size_t i = 0; i < rows; ++i) {
+                        for (size_t j = 0; j < cols; ++j) {
+                            const size_t pixel = (ty * M + i) * out_width + tx * M + j;
+                            float value = plane_addend ? y[i][j] + plane_addend[pixel * pixel_step] : y[i][j];
+                            output[plane + pixel] = relu ? std::max(0.0f, value) : value;
+                        }
+                    }
+                }
+            }
+        }, num_threads);
+    }
+
+private:
+    // alpha x alpha input patch with its top-left corner at (y0, x0), zero outside the image
+    static void LoadTile(const float* image, size_t height, size_t width, long y0, long x0, float (&d)[kAlpha][kAlpha]) {
+        for (size_t i = 0; i < kAlpha; ++i) {
+            const long y = y0 + long(i);
+            for (size_t j = 0; j < kAlpha; ++j) {
+                const long x = x0 + long(j);
+                const bool inside = y >= 0 && x >= 0 && y < long(height) && x < long(width);
+                d[i][j] = inside ? image[y * long(width) + x] : 0.0f;
+            }
+        }
+    }
+
+    static void InputTransform(const float (&d)[kAlpha][kAlpha], float (&v)[kAlpha][kAlpha]) {
+        using W = WinogradMatrices<M>;
+        float t[kAlpha][kAlpha];
+        for (size_t i = 0; i < kAlpha; ++i) {
+            for (size_t j = 0; j < kAlpha; ++j) {
+                float sum = 0.0f;
+                for (size_t k = 0; k < kAlpha; ++k) sum += W::BT[i][k] * d[k][j];
+                t[i][j] = sum;
+            }
+        }
+        for (size_t i = 0; i < kAlpha; ++i) {
+            for (size_t j = 0; j < kAlpha; ++j) {
+                float sum = 0.0f;
+                for (size_t k = 0; k < kAlpha; ++k) sum += t[i][k] * W::BT[j][k];
+                v[i][j] = sum;
+            }
+        }
+    }
+
+    static void OutputTransform(const float (&m)[kAlpha][kAlpha], float (&y)[M][M]) {
+        using W = WinogradMatrices<M>;
+        float t[M][kAlpha];
+        for (size_t i = 0; i < M; ++i) {
+            for (size_t j = 0; j < kAlpha; ++j) {
+                float sum = 0.0f;
+                for (size_t k = 0; k < kAlpha; ++k) sum += W::AT[i][k] * m[k][j];
+                t[i][j] = sum;
+            }
+        }
+        for (size_t i = 0; i < M; ++i) {
+            for (size_t j = 0; j < M; ++j) {
+                float sum = 0.0f;
+                for (size_t k = 0; k < kAlpha; ++k) sum += t[i][k] * W::AT[j][k];
+                y[i][j] = sum;
+            }
+        }
+    }
+};
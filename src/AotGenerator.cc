@@ -0,0 +1,20 @@
+#include "AotModel.h"
+#include "CodeGen.h"
+
+// Writes the AOT test model: <source> <function> [<weights file>]
+int main(int argc, char** argv) try {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <source> <function> [<weights file>]" << std::endl;
+        return 1;
+    }
+    NeuralNetwork nn;
+    BuildAotModel(nn);
+    CodeGen::Options options;
+    options.function = argv[2];
+    if (argc > 3) options.weights_file = argv[3];
+    CodeGen::Write(nn, argv[1], options);
+    return 0;
+} catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,27 @@
+#include "NeuralNetwork.h"
+#include <random>
+
+#pragma once
+
+// Fixed network the AOT tests generate code for: conv + bias + ReLU, a
+// residual elementwise block, a MatMul head and a softmax. Returns its input.
+inline std::shared_ptr<InputData> BuildAotModel(NeuralNetwork& nn) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    const auto random = [&](const std::vector<size_t>& shape) {
+        Tensor tensor(shape);
+        for (size_t i = 0; i < tensor.size(); ++i) tensor.at(i) = dist(gen);
+        return tensor;
+    };
+
+    const auto input = std::make_shared<InputData>(random({1, 3, 8, 8}));
+    const auto conv = nn.addOp(std::make_shared<ConvolOperation>(input, random({8, 3, 3, 3}), 1, 1));
+    const auto biased = nn.addOp(std::make_shared<ScalarAddOperation>(conv, random({1, 8, 8, 8})));
+    const auto x = nn.addOp(std::make_shared<ReLUOperation>(biased));
+    const auto scaled = nn.addOp(std::make_shared<ScalarMulOperation>(x, random({1, 8, 8, 8})));
+    const auto shifted = nn.addOp(std::make_shared<ScalarSubOperation>(scaled, random({1, 8, 8, 8})));
+    const auto residual = nn.addOp(std::make_shared<ScalarAddOperation>(nn.addOp(std::make_shared<ReLUOperation>(shifted)), x));
+    const auto head = nn.addOp(std::make_shared<MatMulOperation>(residual, random({1, 8, 8, 4})));
+    nn.addOp(std::make_shared<SoftmaxOperation>(head, 3));
+    return input;
+}
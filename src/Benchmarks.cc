@@ -0,0 +1,146 @@
+#include <benchmark/benchmark.h>
+#include "NeuralNetwork.h"
+#include <random>
+
+// Kernel throughput: FLOP/s where the work is arithmetic, bytes_per_second for
+// every benchmark (operands read plus results written once). Build in Release;
+// compare runs with --benchmark_format=json --benchmark_out=<file>.
+
+namespace {
+
+std::vector<float> RandomVector(size_t size, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(size);
+    for (auto& x : v) x = dist(gen);
+    return v;
+}
+
+Tensor RandomTensor(const std::vector<size_t>& shape, unsigned seed) {
+    size_t size = 1;
+    for (size_t dim : shape) size *= dim;
+    return Tensor(shape, RandomVector(size, seed));
+}
+
+std::shared_ptr<INode> Placeholder() { return std::make_shared<InputData>(Tensor()); }
+
+void SetFlops(benchmark::State& state, double flops) {
+    state.counters["FLOP/s"] = benchmark::Counter(flops, benchmark::Counter::kIsIterationInvariantRate, benchmark::Counter::OneK::kIs1000);
+}
+
+void SetBytes(benchmark::State& state, size_t bytes) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+} // namespace
+
+
+// C(n x m) = A(n x k) * B(k x m)
+void BM_MatrixMultiplyFast(benchmark::State& state) {
+    const uint32_t n = state.range(0), m = state.range(1), k = state.range(2);
+    const std::vector<float> A = RandomVector(size_t(n) * k, 1), B = RandomVector(size_t(k) * m, 2);
+    std::vector<float> C(size_t(n) * m);
+    for (auto _ : state) {
+        FastMatMul::MatrixMultiplyFast(A, B, C, n, m, k);
+        benchmark::DoNotOptimize(C.data());
+        benchmark::ClobberMemory();
+    }
+    SetFlops(state, 2.0 * n * m * k);
+    SetBytes(state, (size_t(n) * k + size_t(k) * m + size_t(n) * m) * sizeof(float));
+}
+BENCHMARK(BM_MatrixMultiplyFast)
+    ->ArgNames({"n", "m", "k"})
+    // Square
+    ->Args({64, 64, 64})->Args({128, 128, 128})->Args({256, 256, 256})->Args({512, 512, 512})->Args({1024, 1024, 1024})
+    // Skinny: few rows, e.g. batch-1 fully connected layers
+    ->Args({1, 1024, 1024})->Args({8, 1024, 1024})->Args({32, 4096, 256})
+    // Tall: many rows, narrow output, e.g. 1x1 convolutions over large images
+    ->Args({4096, 32, 256})->Args({16384, 64, 64})
+    // Small shape-specialized sizes
+    ->Args({16, 16, 16})->Args({32, 32, 32})
+    ->Unit(benchmark::kMicrosecond);
+
+
+// NCHW convolution with constant weights, batch 1
+void BM_Conv(benchmark::State& state) {
+    const size_t channels = state.range(0), size = state.range(1), filters = state.range(2);
+    const size_t kernel = state.range(3), stride = state.range(4), padding = state.range(5);
+    const Tensor input = RandomTensor({1, channels, size, size}, 3);
+    ConvolOperation conv(Placeholder(), RandomTensor({filters, channels, kernel, kernel}, 4), stride, padding);
+    Tensor output(conv.outputShape(input.shape(), conv.rhsTensor()->shape()), Tensor::Uninitialized());
+    for (auto _ : state) {
+        conv.compute({&input}, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    SetFlops(state, 2.0 * output.size() * channels * kernel * kernel);
+    SetBytes(state, (input.size() + filters * channels * kernel * kernel + output.size()) * sizeof(float));
+}
+BENCHMARK(BM_Conv)
+    ->ArgNames({"c", "hw", "k", "r", "stride", "pad"})
+    // ResNet-50: stem, 3x3 and 1x1 bottleneck layers
+    ->Args({3, 224, 64, 7, 2, 3})
+    ->Args({64, 56, 64, 3, 1, 1})->Args({64, 56, 256, 1, 1, 0})->Args({256, 56, 64, 1, 1, 0})
+    ->Args({128, 28, 128, 3, 1, 1})->Args({256, 14, 256, 3, 1, 1})->Args({512, 7, 512, 3, 1, 1})
+    // MobileNet: stem and pointwise layers
+    ->Args({3, 224, 32, 3, 2, 1})->Args({32, 112, 64, 1, 1, 0})->Args({128, 56, 128, 1, 1, 0})->Args({512, 14, 512, 1, 1, 0})
+    ->Unit(benchmark::kMillisecond);
+
+
+// Softmax over rows of the given length
+void BM_Softmax(benchmark::State& state) {
+    const size_t rows = state.range(0), row_size = state.range(1);
+    const Tensor input = RandomTensor({1, 1, rows, row_size}, 5);
+    const SoftmaxOperation softmax(Placeholder(), 3);
+    Tensor output(input.shape(), Tensor::Uninitialized());
+    for (auto _ : state) {
+        softmax.compute({&input}, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    SetBytes(state, 2 * input.size() * sizeof(float));
+}
+BENCHMARK(BM_Softmax)
+    ->ArgNames({"rows", "row"})
+    ->Args({1, 1000})->Args({64, 1000})->Args({1024, 64})->Args({256, 4096})->Args({1, 1 << 20})
+    ->Unit(benchmark::kMicrosecond);
+
+
+void BM_ReLU(benchmark::State& state) {
+    const size_t size = state.range(0);
+    const Tensor input = RandomTensor({1, 1, 1, size}, 6);
+    const ReLUOperation relu(Placeholder());
+    Tensor output(input.shape(), Tensor::Uninitialized());
+    for (auto _ : state) {
+        relu.compute({&input}, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    SetBytes(state, 2 * size * sizeof(float));
+}
+BENCHMARK(BM_ReLU)->ArgName("n")->RangeMultiplier(16)->Range(1 << 10, 1 << 22)->Unit(benchmark::kMicrosecond);
+
+
+// Elementwise tensor arithmetic: same-shape operands, or a {1, C, 1, 1}
+// per-channel operand broadcast over a {1, C, H, W} one
+template <typename Operation>
+void BM_TensorArithmetic(benchmark::State& state) {
+    const size_t channels = state.range(0), size = state.range(1);
+    const bool broadcast = state.range(2) != 0;
+    const Tensor lhs = RandomTensor({1, channels, size, size}, 7);
+    const Tensor rhs = RandomTensor(broadcast ? std::vector<size_t>{1, channels, 1, 1} : lhs.shape(), 8);
+    const Operation op(Placeholder(), Placeholder());
+    Tensor output(lhs.shape(), Tensor::Uninitialized());
+    for (auto _ : state) {
+        op.compute({&lhs, &rhs}, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    SetFlops(state, static_cast<double>(output.size()));
+    SetBytes(state, (lhs.size() + rhs.size() + output.size()) * sizeof(float));
+}
+#define TENSOR_ARITHMETIC_ARGS \
+    ArgNames({"c", "hw", "broadcast"})->ArgsProduct({{64}, {14, 56}, {0, 1}})->Args({3, 224, 0})->Unit(benchmark::kMicrosecond)
+BENCHMARK_TEMPLATE(BM_TensorArithmetic, ScalarAddOperation)->TENSOR_ARITHMETIC_ARGS;
+BENCHMARK_TEMPLATE(BM_TensorArithmetic, ScalarSubOperation)->TENSOR_ARITHMETIC_ARGS;
+BENCHMARK_TEMPLATE(BM_TensorArithmetic, ScalarMulOperation)->TENSOR_ARITHMETIC_ARGS;
@@ -47,8 +47,9 @@ int main() try{
     
     const auto& input_node = std::make_shared<InputData>(input);
     
-    std::vector<float> bias_values(12, 0.1f); 
-    std::vector<size_t> bias_shape = {1, 3, 2, 2};
+    // One value per channel, broadcast over the image
+    std::vector<float> bias_values(3, 0.1f);
+    std::vector<size_t> bias_shape = {1, 3, 1, 1};
     Tensor bias(bias_shape, bias_values);
     std::cout << "Bias tensor: " << bias << "\n";
     const auto& bias_node = std::make_shared<InputData>(bias);
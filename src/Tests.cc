@@ -1,11 +1,40 @@
 #include <gtest/gtest.h>
 #include "NeuralNetwork.h"
+#include "ModelFile.h"
+#include "CodeGen.h"
+#include "AotModel.h"
 #include <random>
 #include <ctime>
 #include <numeric>
+#include <array>
 
 #define EPSILON 1e-2
 
+// AotModel.h compiled ahead of time, see CMakeLists.txt
+extern "C" void etc_aot_embedded(const float* const* inputs, float* output);
+extern "C" size_t etc_aot_embedded_output_size();
+extern "C" void etc_aot_mapped(const float* const* inputs, float* output);
+
+
+// Column-major C(n x m) = A(n x k) * B(k x m)
+std::vector<float> ReferenceMatMul(const std::vector<float>& A, const std::vector<float>& B,
+                                   uint32_t n, uint32_t m, uint32_t k) {
+    std::vector<float> C(n * m, 0.0f);
+    for (uint32_t j = 0; j < m; ++j)
+        for (uint32_t p = 0; p < k; ++p)
+            for (uint32_t i = 0; i < n; ++i)
+                C[j * n + i] += A[p * n + i] * B[j * k + p];
+    return C;
+}
+
+std::vector<float> RandomVector(size_t size, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(size);
+    for (auto& x : v) x = dist(gen);
+    return v;
+}
+
 
 class TestFastMatMult : public ::testing::Test{
 protected:
@@ -124,6 +153,267 @@ TEST_F(TestFastMatMult, MatrixMultiplyNeon){
 }
 
 
+TEST_F(TestFastMatMult, AllBackendsMatchReference){
+    const std::vector<std::array<uint32_t, 3>> shapes = {
+        {1, 1, 1}, {4, 4, 4}, {7, 5, 3}, {16, 16, 16}, {33, 17, 29}, {64, 3, 100},
+        {257, 50, 400}, {40, 1100, 70}
+    };
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+
+    for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Neon, GemmBackend::Avx2, GemmBackend::Avx512}) {
+        if (!FastMatMul::IsBackendAvailable(backend)) continue;
+        FastMatMul::SetBackend(backend);
+
+        for (const auto& [n, m, k] : shapes) {
+            A = RandomVector(n * k, n + m);
+            B = RandomVector(k * m, m + k);
+            C = ReferenceMatMul(A, B, n, m, k);
+            C_result = FastMatMul::MatrixMultiplyFast(A, B, n, m, k);
+            for (size_t i = 0; i < C.size(); ++i) {
+                EXPECT_NEAR(C[i], C_result[i], 1e-4) << FastMatMul::BackendName(backend);
+            }
+        }
+    }
+    FastMatMul::SetBackend(default_backend);
+}
+
+
+TEST_F(TestFastMatMult, StridedOperands){
+    // Row-major A and B are the transposed column-major views, no copy needed
+    const uint32_t n = 37, m = 23, k = 41;
+    A = RandomVector(n * k, 1);
+    B = RandomVector(k * m, 2);
+
+    std::vector<float> A_col(n * k), B_col(k * m);
+    for (uint32_t i = 0; i < n; ++i)
+        for (uint32_t p = 0; p < k; ++p) A_col[p * n + i] = A[i * k + p];
+    for (uint32_t p = 0; p < k; ++p)
+        for (uint32_t j = 0; j < m; ++j) B_col[j * k + p] = B[p * m + j];
+
+    C = ReferenceMatMul(A_col, B_col, n, m, k);
+    C_result.assign(n * m, 0.0f);
+    FastMatMul::Gemm(n, m, k, A.data(), k, 1, B.data(), m, 1, C_result.data(), n);
+    for (size_t i = 0; i < C.size(); ++i) {
+        EXPECT_NEAR(C[i], C_result[i], 1e-4);
+    }
+
+    // Zero depth still overwrites C, with the epilogue applied to 0
+    const std::vector<float> D = RandomVector(n * m, 3);
+    GemmEpilogue epilogue;
+    epilogue.addend = D.data();
+    epilogue.ld_addend = n;
+    C_result.assign(n * m, 7.0f);
+    FastMatMul::Gemm(n, m, 0, A.data(), k, 1, B.data(), m, 1, C_result.data(), n);
+    EXPECT_EQ(C_result, std::vector<float>(n * m, 0.0f));
+    C_result.assign(n * m, 7.0f);
+    FastMatMul::GemmImplicit(n, m, 0, StridedMatrix{A.data(), k, 1}, B.data(), m, 1, C_result.data(), n, &epilogue);
+    EXPECT_EQ(C_result, D);
+}
+
+
+TEST_F(TestFastMatMult, MultithreadedMatchesReference){
+    const size_t default_threads = FastMatMul::GetNumThreads();
+    FastMatMul::SetNumThreads(4);
+
+    for (const auto& [n, m, k] : std::vector<std::array<uint32_t, 3>>{{5, 7, 3}, {300, 130, 500}, {16, 900, 20}}) {
+        A = RandomVector(n * k, n);
+        B = RandomVector(k * m, m);
+        C = ReferenceMatMul(A, B, n, m, k);
+        C_result = FastMatMul::MatrixMultiplyFast(A, B, n, m, k);
+        for (size_t i = 0; i < C.size(); ++i) {
+            EXPECT_NEAR(C[i], C_result[i], 1e-3);
+        }
+    }
+
+    // Empty C: nothing to split between the threads
+    A = RandomVector(20 * 30, 1);
+    B = RandomVector(30 * 40, 2);
+    C_result.assign(20 * 40, 7.0f);
+    FastMatMul::Gemm(0, 40, 30, A.data(), 1, 20, B.data(), 1, 30, C_result.data(), 20);
+    FastMatMul::Gemm(20, 0, 30, A.data(), 1, 20, B.data(), 1, 30, C_result.data(), 20);
+    const FastMatMul::PackedMatrix packed = FastMatMul::Prepack(30, 40, B.data(), 1, 30);
+    const auto a_of = [&](size_t) { return StridedMatrix{A.data(), 1, 20}; };
+    FastMatMul::GemmPacked(0, 20, a_of, packed, C_result.data(), 20, 20 * 40);
+    FastMatMul::GemmPacked(1, 0, a_of, packed, C_result.data(), 20, 20 * 40);
+    EXPECT_EQ(C_result, std::vector<float>(20 * 40, 7.0f));
+    FastMatMul::SetNumThreads(default_threads);
+}
+
+
+TEST_F(TestFastMatMult, EpilogueMatchesReference){
+    const uint32_t n = 70, m = 30, k = 500;
+    A = RandomVector(n * k, 8);
+    B = RandomVector(k * m, 9);
+    const std::vector<float> D = RandomVector(n * m, 10);
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+
+    GemmEpilogue epilogue;
+    epilogue.addend = D.data();
+    epilogue.ld_addend = n;
+    epilogue.relu = true;
+
+    C = ReferenceMatMul(A, B, n, m, k);
+    for (size_t i = 0; i < C.size(); ++i) C[i] = std::max(0.0f, C[i] + D[i]);
+
+    for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Neon, GemmBackend::Avx2, GemmBackend::Avx512}) {
+        if (!FastMatMul::IsBackendAvailable(backend)) continue;
+        FastMatMul::SetBackend(backend);
+
+        C_result.assign(n * m, 0.0f);
+        FastMatMul::Gemm(n, m, k, A.data(), 1, n, B.data(), 1, k, C_result.data(), n, &epilogue);
+        for (size_t i = 0; i < C.size(); ++i) {
+            EXPECT_NEAR(C[i], C_result[i], 1e-3) << FastMatMul::BackendName(backend);
+        }
+
+        // Per-column (rs_addend 0) and per-row (ld_addend 0) bias, blocked and shape-specialized
+        for (const uint32_t size : {n, 16u}) {
+            const uint32_t rows = size, cols = size == n ? m : size;
+            for (const bool per_column : {true, false}) {
+                GemmEpilogue bias;
+                bias.addend = D.data();
+                bias.rs_addend = per_column ? 0 : 1;
+                bias.ld_addend = per_column ? 1 : 0;
+                const std::vector<float> product = ReferenceMatMul(std::vector<float>(A.begin(), A.begin() + rows * k),
+                                                                   std::vector<float>(B.begin(), B.begin() + k * cols), rows, cols, k);
+                C_result.assign(rows * cols, 0.0f);
+                FastMatMul::Gemm(rows, cols, k, A.data(), 1, rows, B.data(), 1, k, C_result.data(), rows, &bias);
+                for (uint32_t j = 0; j < cols; ++j)
+                    for (uint32_t i = 0; i < rows; ++i)
+                        EXPECT_NEAR(C_result[i + j * rows], product[i + j * rows] + D[per_column ? j : i], 1e-3) << FastMatMul::BackendName(backend);
+            }
+        }
+    }
+    FastMatMul::SetBackend(default_backend);
+}
+
+
+TEST_F(TestFastMatMult, SmallShapeKernels){
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+    // Shapes of the precompiled set, then ones falling back to the blocked GEMM
+    const std::array<std::array<uint32_t, 3>, 6> shapes = {{{8, 8, 8}, {16, 64, 32}, {64, 8, 16}, {32, 32, 64}, {24, 8, 8}, {8, 8, 12}}};
+    EXPECT_TRUE(FastMatMul::HasSmallKernel(16, 64, 32));
+    EXPECT_FALSE(FastMatMul::HasSmallKernel(24, 8, 8));
+
+    for (const auto& [n, m, k] : shapes) {
+        A = RandomVector(n * k, n + k);
+        B = RandomVector(k * m, m + k);
+        const std::vector<float> D = RandomVector(n * m, n + m);
+        GemmEpilogue epilogue;
+        epilogue.addend = D.data();
+        epilogue.ld_addend = n;
+        epilogue.relu = true;
+
+        C = ReferenceMatMul(A, B, n, m, k);
+        for (size_t i = 0; i < C.size(); ++i) C[i] = std::max(0.0f, C[i] + D[i]);
+
+        for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Neon, GemmBackend::Avx2, GemmBackend::Avx512}) {
+            if (!FastMatMul::IsBackendAvailable(backend)) continue;
+            FastMatMul::SetBackend(backend);
+
+            C_result.assign(n * m, 0.0f);
+            FastMatMul::Gemm(n, m, k, A.data(), 1, n, B.data(), 1, k, C_result.data(), n, &epilogue);
+            for (size_t i = 0; i < C.size(); ++i) {
+                EXPECT_NEAR(C[i], C_result[i], 1e-3) << FastMatMul::BackendName(backend) << " " << n << "x" << m << "x" << k;
+            }
+        }
+    }
+    FastMatMul::SetBackend(default_backend);
+}
+
+
+TEST_F(TestFastMatMult, HalfPrecisionStorage) {
+    // Rounding to nearest even, overflow to infinity, subnormals and NaN
+    EXPECT_EQ(half::FloatToBf16(1.0f), 0x3f80);
+    EXPECT_EQ(half::FloatToBf16(1.0f + 0x1.0p-8f), 0x3f80);
+    EXPECT_EQ(half::FloatToBf16(1.0f + 0x1.8p-7f), 0x3f82);
+    EXPECT_EQ(half::FloatToF16(1.0f + 0x1.0p-11f), 0x3c00);
+    EXPECT_EQ(half::FloatToF16(-2.0f), 0xc000);
+    EXPECT_EQ(half::FloatToF16(65504.0f), 0x7bff);
+    EXPECT_EQ(half::FloatToF16(65520.0f), 0x7c00);
+    EXPECT_EQ(half::FloatToF16(0x1.0p-24f), 0x0001);
+    EXPECT_EQ(half::F16ToFloat(0x0001), 0x1.0p-24f);
+    EXPECT_TRUE(std::isnan(half::F16ToFloat(half::FloatToF16(NAN))));
+    EXPECT_TRUE(std::isnan(half::Bf16ToFloat(half::FloatToBf16(NAN))));
+
+    // The vector kernels agree with the software conversions, tails included
+    A = RandomVector(1001, 13);
+    for (float& x : A) x *= 1000.0f;
+    for (DType dtype : {DType::BF16, DType::F16}) {
+        std::vector<uint16_t> converted(A.size());
+        HalfConvert::FromFloat(dtype, A.data(), converted.data(), A.size());
+        std::vector<float> widened(A.size());
+        HalfConvert::ToFloat(dtype, converted.data(), widened.data(), A.size());
+        for (size_t i = 0; i < A.size(); ++i) {
+            const uint16_t expected = dtype == DType::BF16 ? half::FloatToBf16(A[i]) : half::FloatToF16(A[i]);
+            ASSERT_EQ(converted[i], expected) << DTypeName(dtype) << " " << A[i];
+            ASSERT_EQ(widened[i], half::ToFloat(dtype, expected));
+        }
+    }
+
+    // 16-bit weights and activations, f32 accumulation: within the inputs' rounding
+    const uint32_t n = 45, m = 37, k = 300;
+    Tensor lhs({1, 2, n, k}, RandomVector(2 * n * k, 14));
+    Tensor rhs({1, 2, k, m}, RandomVector(2 * k * m, 15));
+    const Tensor reference = MatMulOperation(lhs, rhs).evaluate();
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+    for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Avx2, GemmBackend::Avx512, GemmBackend::Neon}) {
+        if (!FastMatMul::IsBackendAvailable(backend)) continue;
+        FastMatMul::SetBackend(backend);
+        for (DType dtype : {DType::BF16, DType::F16}) {
+            const float tolerance = dtype == DType::BF16 ? 0.2f : 0.03f;
+            MatMulOperation matmul(lhs.toDType(dtype), rhs.toDType(dtype));
+            EXPECT_EQ(matmul.rhsTensor()->dtype(), dtype);
+            const Tensor result = matmul.evaluate();
+            ASSERT_EQ(result.dtype(), DType::F32);
+            for (size_t i = 0; i < result.size(); ++i)
+                ASSERT_NEAR(result.at(i), reference.at(i), tolerance) << FastMatMul::BackendName(backend) << " " << DTypeName(dtype);
+        }
+    }
+    FastMatMul::SetBackend(default_backend);
+    EXPECT_THROW(ReLUOperation(lhs.toDType(DType::BF16)).evaluate(), std::invalid_argument);
+}
+
+
+TEST_F(TestFastMatMult, TensorViewGemm) {
+    Tensor a({2, 3, 4, 5}, RandomVector(120, 11));
+    Tensor b({2, 3, 6, 5}, RandomVector(180, 12));
+
+    // Views share storage: slicing and transposing copy nothing
+    const ConstTensorView a_view(a);
+    const ConstTensorView b_t = ConstTensorView(b).transpose(2, 3); // [2, 3, 5, 6]
+    EXPECT_EQ(b_t.data(), b.data());
+    EXPECT_FALSE(b_t.is_contiguous());
+    EXPECT_EQ(b_t.at(1, 2, 4, 3), b.at(1, 2, 3, 4));
+    EXPECT_EQ(a_view.slice(1, 1, 3).at(0, 1, 2, 3), a.at(0, 2, 2, 3));
+    EXPECT_THROW(b_t.reshape({2, 3, 30, 1}), std::invalid_argument);
+
+    const Tensor b_copy = b_t.contiguous();
+    EXPECT_EQ(b_copy.shape(), (std::vector<size_t>{2, 3, 5, 6}));
+    EXPECT_EQ(b_copy.at(1, 2, 4, 3), b.at(1, 2, 3, 4));
+
+    // Row-major C = A * B^T, with B^T read through its view
+    Tensor c(2, 3, 4, 6);
+    FastMatMul::Gemm(a_view, b_t, TensorView(c));
+
+    // Only channels 1..2 into a column-major output view
+    Tensor c_cols(2, 2, 6, 4);
+    const TensorView c_cm = TensorView(c_cols).transpose(2, 3);
+    FastMatMul::Gemm(a_view.slice(1, 1, 3), b_t.slice(1, 1, 3), c_cm);
+
+    for (size_t n = 0; n < 2; ++n)
+        for (size_t ch = 0; ch < 3; ++ch)
+            for (size_t i = 0; i < 4; ++i)
+                for (size_t j = 0; j < 6; ++j) {
+                    float expected = 0.0f;
+                    for (size_t p = 0; p < 5; ++p) expected += a.at(n, ch, i, p) * b.at(n, ch, j, p);
+                    EXPECT_NEAR(c.at(n, ch, i, j), expected, 1e-4);
+                    if (ch > 0) {
+                        EXPECT_NEAR(c_cm.at(n, ch - 1, i, j), expected, 1e-4);
+                    }
+                }
+}
+
+
 // ------------------------------- TESTS BINARY OPS -------------------------------
 
 
@@ -258,6 +548,350 @@ TEST_F(TestBinaryOperation, MatMulOperation) {
 }
 
 
+TEST_F(TestBinaryOperation, BatchedMatMulOperation) {
+    NeuralNetwork nn;
+
+    const size_t batch = 2, channels = 3, n = 5, k = 7, m = 4;
+    delete t1;
+    t1 = new Tensor({batch, channels, n, k}, RandomVector(batch * channels * n * k, 3));
+    t2 = new Tensor({batch, channels, k, m}, RandomVector(batch * channels * k * m, 4));
+
+    const auto& mul_op = std::make_shared<MatMulOperation>(std::make_shared<InputData>(*t1), *t2);
+    nn.addOp(mul_op);
+
+    Tensor output = nn.infer();
+    ASSERT_EQ(output.shape(), (std::vector<size_t>{batch, channels, n, m}));
+
+    // Each (b, c) slice is an independent column-major product
+    for (size_t s = 0; s < batch * channels; ++s) {
+        std::vector<float> lhs(t1->data() + s * n * k, t1->data() + (s + 1) * n * k);
+        std::vector<float> rhs(t2->data() + s * k * m, t2->data() + (s + 1) * k * m);
+        std::vector<float> expected = ReferenceMatMul(lhs, rhs, n, m, k);
+        for (size_t i = 0; i < n * m; ++i) {
+            EXPECT_NEAR(output.data()[s * n * m + i], expected[i], 1e-4);
+        }
+    }
+}
+
+
+TEST_F(TestBinaryOperation, ConvolMatchesDirectConvolution) {
+    t2 = new Tensor({4, 3, 3, 3}, RandomVector(108, 9));
+    Tensor input({2, 3, 5, 6}, RandomVector(180, 10));
+
+    for (auto [stride, algorithm] : std::vector<std::pair<size_t, ConvAlgorithm>>{
+             {1, ConvAlgorithm::Im2Col}, {2, ConvAlgorithm::Im2Col},
+             {1, ConvAlgorithm::ImplicitGemm}, {2, ConvAlgorithm::ImplicitGemm}}) {
+        const size_t padding = 1;
+        ConvolOperation conv(input, *t2, stride, padding);
+        conv.setAlgorithm(algorithm);
+        Tensor output = conv.evaluate();
+        ASSERT_EQ(output.shape(), conv.outputShape(input.shape(), t2->shape()));
+
+        // Direct cross-correlation with zero padding
+        for (size_t b = 0; b < output.shape(0); ++b)
+            for (size_t oc = 0; oc < output.shape(1); ++oc)
+                for (size_t oh = 0; oh < output.shape(2); ++oh)
+                    for (size_t ow = 0; ow < output.shape(3); ++ow) {
+                        float expected = 0.0f;
+                        for (size_t ic = 0; ic < 3; ++ic)
+                            for (size_t kh = 0; kh < 3; ++kh)
+                                for (size_t kw = 0; kw < 3; ++kw) {
+                                    const long h = long(oh * stride + kh) - long(padding);
+                                    const long w = long(ow * stride + kw) - long(padding);
+                                    if (h < 0 || w < 0 || h >= 5 || w >= 6) continue;
+                                    expected += input.at(b, ic, h, w) * t2->at(oc, ic, kh, kw);
+                                }
+                        EXPECT_NEAR(output.at(b, oc, oh, ow), expected, 1e-4);
+                    }
+    }
+}
+
+
+TEST_F(TestBinaryOperation, WinogradMatchesIm2Col) {
+    t2 = new Tensor({9, 8, 3, 3}, RandomVector(648, 14));
+    Tensor input({2, 8, 11, 9}, RandomVector(1584, 15));
+    Tensor bias({2, 9, 11, 9}, RandomVector(1782, 16));
+
+    for (size_t padding : {0, 1}) {
+        ConvolOperation conv(input, *t2, 1, padding);
+        EXPECT_EQ(conv.chooseAlgorithm(input.shape(), t2->shape()), ConvAlgorithm::Winograd4x4);
+        conv.setAlgorithm(ConvAlgorithm::Im2Col);
+        const Tensor reference = conv.evaluate();
+
+        for (ConvAlgorithm algorithm : {ConvAlgorithm::ImplicitGemm, ConvAlgorithm::Winograd2x2, ConvAlgorithm::Winograd4x4}) {
+            conv.setAlgorithm(algorithm);
+            for (int run = 0; run < 2; ++run) {  // second run uses the cached Winograd filters
+                const Tensor output = conv.evaluate();
+                ASSERT_EQ(output.shape(), reference.shape());
+                for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), 1e-3);
+            }
+        }
+
+        // Fused bias + ReLU in the output transform
+        if (padding == 1) {
+            Epilogue epilogue;
+            epilogue.addend = &bias;
+            epilogue.relu = true;
+            Tensor fused(reference.shape());
+            conv.compute({}, fused, epilogue);
+            for (size_t i = 0; i < fused.size(); ++i) EXPECT_NEAR(fused.at(i), std::max(0.0f, reference.at(i) + bias.at(i)), 1e-3);
+        }
+    }
+
+    // Shapes Winograd does not cover fall back to im2col, or throw when forced
+    EXPECT_EQ(ConvolOperation(input, *t2, 1, 0).chooseAlgorithm({2, 8, 6, 6}, t2->shape()), ConvAlgorithm::ImplicitGemm);
+    ConvolOperation strided(input, *t2, 2, 1);
+    EXPECT_EQ(strided.chooseAlgorithm(input.shape(), t2->shape()), ConvAlgorithm::ImplicitGemm);
+    strided.setAlgorithm(ConvAlgorithm::Winograd2x2);
+    EXPECT_THROW(strided.evaluate(), std::invalid_argument);
+}
+
+
+TEST_F(TestBinaryOperation, BatchedConvolutionPackedWeights) {
+    t2 = new Tensor({10, 5, 3, 3}, RandomVector(450, 17));
+    Tensor input({4, 5, 9, 7}, RandomVector(1260, 18));
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+
+    ConvolOperation reference_conv(input, *t2, 1, 1);
+    reference_conv.setAlgorithm(ConvAlgorithm::Im2Col);
+    const Tensor reference = reference_conv.evaluate();
+
+    // Weights are packed once and repacked when the backend changes
+    ConvolOperation conv(input, *t2, 1, 1);
+    conv.setAlgorithm(ConvAlgorithm::ImplicitGemm);
+    for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Neon, GemmBackend::Avx2, GemmBackend::Avx512}) {
+        if (!FastMatMul::IsBackendAvailable(backend)) continue;
+        FastMatMul::SetBackend(backend);
+        for (int run = 0; run < 2; ++run) {
+            const Tensor output = conv.evaluate();
+            ASSERT_EQ(output.shape(), reference.shape());
+            for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), 1e-4) << FastMatMul::BackendName(backend);
+        }
+    }
+
+    // Packed operands belong to the backend that packed them
+    FastMatMul::SetBackend(GemmBackend::Scalar);
+    const FastMatMul::PackedMatrix packed = FastMatMul::Prepack(45, 10, t2->data(), 1, 45);
+    FastMatMul::SetBackend(default_backend);
+    if (default_backend != GemmBackend::Scalar) {
+        std::vector<float> out(63 * 10);
+        EXPECT_THROW(FastMatMul::GemmPacked(1, 63, [&](size_t) { return StridedMatrix{input.data(), 1, 63}; },
+                                            packed, out.data(), 63, 0), std::invalid_argument);
+    }
+}
+
+
+TEST_F(TestBinaryOperation, ConstantOperandCache) {
+    t2 = new Tensor({2, 3, 7, 5}, RandomVector(210, 23));
+    Tensor lhs({2, 3, 6, 7}, RandomVector(252, 24));
+    Tensor bias({2, 3, 6, 5}, RandomVector(180, 25));
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+    const auto lhs_node = std::make_shared<InputData>(lhs);
+    const auto rhs_node = std::make_shared<InputData>(*t2);
+
+    Epilogue epilogue;
+    epilogue.addend = &bias;
+    epilogue.relu = true;
+    const Tensor reference = MatMulOperation(lhs_node, rhs_node).compute({&lhs, t2}, epilogue);
+
+    // One packed copy of the weights per backend, reused by later runs
+    MatMulOperation matmul(lhs_node, *t2);
+    size_t backends = 0;
+    for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Neon, GemmBackend::Avx2, GemmBackend::Avx512}) {
+        if (!FastMatMul::IsBackendAvailable(backend)) continue;
+        FastMatMul::SetBackend(backend);
+        ++backends;
+        for (int run = 0; run < 2; ++run) {
+            const Tensor output = matmul.compute({&lhs}, epilogue);
+            ASSERT_EQ(output.shape(), reference.shape());
+            for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), 1e-4) << FastMatMul::BackendName(backend);
+            EXPECT_EQ(matmul.cachedConstants(), backends);
+        }
+    }
+    FastMatMul::SetBackend(default_backend);
+    matmul.clearConstantCache();
+    EXPECT_EQ(matmul.cachedConstants(), 0u);
+
+    // Operands computed by other nodes are never cached
+    MatMulOperation(lhs_node, rhs_node).compute({&lhs, t2});
+    ConvolOperation conv(std::make_shared<InputData>(Tensor({1, 3, 8, 8}, RandomVector(192, 26))), Tensor({4, 3, 3, 3}, RandomVector(108, 27)), 1, 1);
+    conv.evaluate();
+    conv.evaluate();
+    EXPECT_EQ(conv.cachedConstants(), 1u);
+
+    // Weights stored in another layout are reordered while building each form,
+    // which is then cached like any other
+    const auto conv_input = std::make_shared<InputData>(Tensor({1, 3, 8, 8}, RandomVector(192, 26)));
+    ConvolOperation blocked_weights(conv_input, conv.rhsTensor()->toLayout(LayoutAssignment::PreferredBlockedLayout()), 1, 1);
+    for (ConvAlgorithm algorithm : {ConvAlgorithm::ImplicitGemm, ConvAlgorithm::Winograd4x4}) {
+        conv.setAlgorithm(algorithm);
+        blocked_weights.setAlgorithm(algorithm);
+        const Tensor expected = conv.evaluate();
+        for (int run = 0; run < 2; ++run) {
+            const Tensor output = blocked_weights.evaluate();
+            for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), expected.at(i), 1e-4);
+        }
+    }
+    EXPECT_EQ(blocked_weights.cachedConstants(), 2u);
+}
+
+
+TEST_F(TestBinaryOperation, Int8ConvAndMatMul) {
+    // Per-channel weights round-trip within half a step of their channel's scale
+    t2 = new Tensor({20, 5, 3, 3}, RandomVector(900, 40));
+    for (size_t i = 0; i < 45; ++i) t2->at(i) *= 0.01f;
+    const QuantizedTensor weights = QuantizedTensor::QuantizePerChannel(*t2);
+    const Tensor restored = weights.Dequantize();
+    for (size_t i = 0; i < t2->size(); ++i)
+        EXPECT_NEAR(restored.at(i), t2->at(i), weights.paramsAt(i).scale * 0.5f + 1e-7f);
+    EXPECT_LT(weights.params().front().scale, 0.01f * weights.params().back().scale * 1.1f);
+    EXPECT_THROW(QuantizedTensor({2, 3}, {QuantParams()}, 1), std::invalid_argument);
+
+    auto max_abs = [](const Tensor& t) {
+        float value = 0.0f;
+        for (size_t i = 0; i < t.size(); ++i) value = std::max(value, std::fabs(t.at(i)));
+        return value;
+    };
+    auto expect_close = [&](const Tensor& output, const Tensor& reference, float tolerance) {
+        ASSERT_EQ(output.shape(), reference.shape());
+        for (size_t i = 0; i < output.size(); ++i) ASSERT_NEAR(output.at(i), reference.at(i), tolerance) << i;
+    };
+
+    // Odd sizes leave row, panel and depth tails; the 1x1 layer reads its input in place
+    Tensor input({2, 5, 9, 13}, RandomVector(1170, 41));
+    Tensor lhs({1, 2, 37, 23}, RandomVector(1702, 43));
+    Tensor rhs({1, 2, 23, 6}, RandomVector(276, 44));
+    Tensor addend({1, 2, 37, 6}, RandomVector(444, 45));
+    Tensor pointwise({7, 5, 1, 1}, RandomVector(35, 42));
+    const QuantParams activation = QuantParams::FromRange(-1.0f, 1.0f);
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+    std::vector<Tensor> scalar_results;
+    for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Avx2, GemmBackend::Avx512}) {
+        if (!FastMatMul::IsBackendAvailable(backend)) continue;
+        FastMatMul::SetBackend(backend);
+        std::vector<Tensor> results;
+
+        ConvolOperation conv(input, *t2, 2, 1);
+        const Tensor conv_reference = conv.evaluate();
+        conv.setQuantization(activation);
+        results.push_back(conv.evaluate());
+        expect_close(results.back(), conv_reference, 0.02f * max_abs(conv_reference));
+
+        ConvolOperation conv1x1(input, pointwise, 1, 0);
+        const Tensor conv1x1_reference = conv1x1.evaluate();
+        conv1x1.setQuantization(activation);
+        results.push_back(conv1x1.evaluate());
+        expect_close(results.back(), conv1x1_reference, 0.02f * max_abs(conv1x1_reference));
+
+        // Bias and ReLU run in the dequantizing store
+        MatMulOperation matmul(lhs, rhs);
+        Tensor matmul_reference = matmul.evaluate();
+        matmul_reference += addend;
+        for (size_t i = 0; i < matmul_reference.size(); ++i) matmul_reference.at(i) = std::max(matmul_reference.at(i), 0.0f);
+        matmul.setQuantization(activation);
+        Epilogue epilogue;
+        epilogue.addend = &addend;
+        epilogue.relu = true;
+        Tensor matmul_result(matmul_reference.shape(), Tensor::Uninitialized());
+        matmul.compute(lhs, *matmul.rhsTensor(), matmul_result, epilogue);
+        results.push_back(matmul_result);
+        expect_close(results.back(), matmul_reference, 0.02f * max_abs(matmul_reference));
+
+        // Every kernel accumulates the same integers
+        if (scalar_results.empty()) scalar_results = results;
+        for (size_t r = 0; r < results.size(); ++r) expect_close(results[r], scalar_results[r], 1e-5f);
+    }
+    FastMatMul::SetBackend(default_backend);
+}
+
+
+TEST_F(TestBinaryOperation, BroadcastElementwise) {
+    t2 = new Tensor({1, 3, 1, 1}, std::vector<float>{1.0f, -2.0f, 3.0f});
+    Tensor input({2, 3, 4, 5}, RandomVector(120, 32));
+
+    // Reference: operands indexed with their size-1 dimensions pinned to 0
+    auto reference = [](const Tensor& a, const Tensor& b, auto op) {
+        std::vector<size_t> shape(4);
+        for (size_t d = 0; d < 4; ++d) shape[d] = std::max(a.shape(d), b.shape(d));
+        Tensor out(shape, Tensor::Uninitialized());
+        auto at = [](const Tensor& t, size_t n, size_t c, size_t h, size_t w) {
+            return t.at(t.shape(0) == 1 ? 0 : n, t.shape(1) == 1 ? 0 : c, t.shape(2) == 1 ? 0 : h, t.shape(3) == 1 ? 0 : w);
+        };
+        for (size_t n = 0; n < shape[0]; ++n)
+            for (size_t c = 0; c < shape[1]; ++c)
+                for (size_t h = 0; h < shape[2]; ++h)
+                    for (size_t w = 0; w < shape[3]; ++w) out.at(n, c, h, w) = op(at(a, n, c, h, w), at(b, n, c, h, w));
+        return out;
+    };
+    auto expect_equal = [](const Tensor& output, const Tensor& expected) {
+        ASSERT_EQ(output.shape(), expected.shape());
+        for (size_t i = 0; i < expected.size(); ++i) EXPECT_FLOAT_EQ(output.at(i), expected.at(i));
+    };
+
+    // Per-channel, per-row and both-sided broadcasts, either operand
+    Tensor row({1, 1, 1, 5}, RandomVector(5, 33));
+    Tensor column({2, 1, 4, 1}, RandomVector(8, 34));
+    Tensor scale({1, 3, 1, 5}, RandomVector(15, 35));
+    expect_equal(ScalarAddOperation(input, *t2).evaluate(), reference(input, *t2, std::plus<float>()));
+    expect_equal(ScalarSubOperation(row, input).evaluate(), reference(row, input, std::minus<float>()));
+    expect_equal(ScalarMulOperation(column, scale).evaluate(), reference(column, scale, std::multiplies<float>()));
+
+    // Lower-rank operands align at the last dimension
+    const Tensor flat_row = Tensor::Wrap({5}, row.data());
+    EXPECT_EQ(ScalarAddOperation(input, flat_row).evaluate().GetData(), ScalarAddOperation(input, row).evaluate().GetData());
+    EXPECT_THROW(ScalarAddOperation(input, Tensor({1, 2, 1, 1}, std::vector<float>{1.0f, 2.0f})).evaluate(), std::invalid_argument);
+
+    // A per-channel bias on channel-blocked activations stays C floats
+    const auto blocked_input = std::make_shared<InputData>(input.toLayout(Layout::NCHW16c));
+    const Tensor blocked = ScalarAddOperation(blocked_input, *t2).evaluate();
+    EXPECT_EQ(blocked.layout(), Layout::NCHW16c);
+    expect_equal(blocked.toLayout(Layout::NCHW), reference(input, *t2, std::plus<float>()));
+}
+
+
+TEST_F(TestBinaryOperation, BlockedConvolution) {
+    t2 = new Tensor({10, 5, 3, 3}, RandomVector(450, 20));
+    Tensor input({2, 5, 9, 17}, RandomVector(1530, 21));
+    Tensor bias({2, 10, 9, 17}, RandomVector(3060, 22));
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+
+    for (size_t stride : {1, 2}) {
+        ConvolOperation conv(input, *t2, stride, 1);
+        conv.setAlgorithm(ConvAlgorithm::Im2Col);
+        const Tensor reference = conv.evaluate();
+        const Tensor* addend = stride == 1 ? &bias : nullptr;
+
+        // Portable and SIMD kernels, padded channel blocks, NCHW and blocked addends
+        for (GemmBackend backend : {GemmBackend::Scalar, default_backend}) {
+            FastMatMul::SetBackend(backend);
+            for (Layout layout : {Layout::NCHW8c, Layout::NCHW16c}) {
+                const Tensor blocked_input = input.toLayout(layout);
+                const Tensor output = conv.compute(blocked_input, *t2);
+                ASSERT_EQ(output.layout(), layout);
+                ASSERT_EQ(output.shape(), reference.shape());
+                for (size_t i = 0; i < reference.size(); ++i) {
+                    const auto& s = reference.shape();
+                    const size_t w = i % s[3], h = i / s[3] % s[2], c = i / s[3] / s[2] % s[1], n = i / s[3] / s[2] / s[1];
+                    EXPECT_NEAR(output.at(n, c, h, w), reference.at(i), 1e-4) << LayoutName(layout);
+                }
+
+                if (!addend) continue;
+                Epilogue epilogue;
+                epilogue.addend = addend;
+                epilogue.relu = true;
+                Tensor fused(reference.shape(), layout, Tensor::Uninitialized());
+                conv.compute(blocked_input, *t2, fused, epilogue);
+                const Tensor fused_nchw = fused.toLayout(Layout::NCHW);
+                for (size_t i = 0; i < reference.size(); ++i)
+                    EXPECT_NEAR(fused_nchw.at(i), std::max(0.0f, reference.at(i) + bias.at(i)), 1e-4);
+            }
+        }
+        FastMatMul::SetBackend(default_backend);
+    }
+    EXPECT_THROW(ConvolOperation(input.toLayout(Layout::NHWC), *t2, 1, 1).evaluate(), std::invalid_argument);
+}
+
+
 TEST_F(TestBinaryOperation, ConvolOperation) {
     NeuralNetwork nn;
 
@@ -371,6 +1005,75 @@ TEST_F(TestUnaryOperation, SoftmaxOperation) {
 }
 
 
+TEST_F(TestUnaryOperation, SoftmaxAxisAndLargeLogits) {
+    // Logits far beyond exp's range, rows of every tail length
+    Tensor input({2, 3, 5, 37}, RandomVector(1110, 28));
+    for (size_t i = 0; i < input.size(); ++i) input.at(i) = input.at(i) * 200.0f + (i % 7 == 0 ? 1000.0f : 0.0f);
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+
+    for (size_t axis : {1, 2, 3}) {
+        size_t row_size = 1;
+        for (size_t d = axis; d < 4; ++d) row_size *= input.shape(d);
+
+        // Reference in double precision
+        std::vector<double> expected(input.size());
+        for (size_t row = 0; row < input.size() / row_size; ++row) {
+            const float* x = input.data() + row * row_size;
+            const double max = *std::max_element(x, x + row_size);
+            double sum = 0.0;
+            for (size_t i = 0; i < row_size; ++i) sum += std::exp(x[i] - max);
+            for (size_t i = 0; i < row_size; ++i) expected[row * row_size + i] = std::exp(x[i] - max) / sum;
+        }
+
+        for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Avx2, GemmBackend::Avx512}) {
+            if (!FastMatMul::IsBackendAvailable(backend)) continue;
+            FastMatMul::SetBackend(backend);
+            const Tensor output = SoftmaxOperation(input, axis).evaluate();
+            for (size_t i = 0; i < output.size(); ++i)
+                ASSERT_NEAR(output.at(i), expected[i], 1e-6 + 1e-5 * expected[i]) << FastMatMul::BackendName(backend) << " axis " << axis;
+        }
+    }
+    FastMatMul::SetBackend(default_backend);
+    EXPECT_THROW(SoftmaxOperation(input, 4).evaluate(), std::invalid_argument);
+}
+
+
+TEST_F(TestUnaryOperation, LayoutReorder) {
+    Tensor nchw({2, 5, 3, 4}, RandomVector(120, 19));
+
+    for (Layout layout : {Layout::NHWC, Layout::NCHW8c, Layout::NCHW16c}) {
+        const Tensor stored = ReorderOperation(nchw, layout).evaluate();
+        EXPECT_EQ(stored.layout(), layout);
+        EXPECT_EQ(stored.shape(), nchw.shape());
+        EXPECT_EQ(stored.size(), StorageSize(nchw.shape(), layout));
+
+        // Same logical elements, padding lanes zero
+        for (size_t n = 0; n < 2; ++n)
+            for (size_t c = 0; c < 5; ++c)
+                for (size_t h = 0; h < 3; ++h)
+                    for (size_t w = 0; w < 4; ++w) EXPECT_EQ(stored.at(n, c, h, w), nchw.at(n, c, h, w));
+        const float sum = std::accumulate(stored.data(), stored.data() + stored.size(), 0.0f);
+        EXPECT_NEAR(sum, std::accumulate(nchw.data(), nchw.data() + nchw.size(), 0.0f), 1e-4);
+
+        // Elementwise kernels run on any layout
+        const Tensor relu = ReLUOperation(stored).evaluate();
+        EXPECT_EQ(relu.layout(), layout);
+        EXPECT_EQ(relu.at(1, 4, 2, 3), std::max(0.0f, nchw.at(1, 4, 2, 3)));
+
+        const Tensor back = stored.toLayout(Layout::NHWC).toLayout(Layout::NCHW);
+        EXPECT_EQ(back.layout(), Layout::NCHW);
+        for (size_t i = 0; i < nchw.size(); ++i) EXPECT_EQ(back.at(i), nchw.at(i));
+    }
+
+    // NHWC is a strided view of the logical tensor; blocked layouts cannot be viewed
+    const Tensor nhwc = nchw.toLayout(Layout::NHWC);
+    EXPECT_EQ(ConstTensorView(nhwc).at(1, 3, 2, 1), nchw.at(1, 3, 2, 1));
+    EXPECT_EQ(ConstTensorView(nhwc).contiguous().GetData(), nchw.GetData());
+    EXPECT_THROW(ConstTensorView(nchw.toLayout(Layout::NCHW8c)), std::invalid_argument);
+    EXPECT_THROW(SoftmaxOperation(nhwc).evaluate(), std::invalid_argument);
+}
+
+
 // ------------------------------- TESTS NN -------------------------------
 
 
@@ -407,6 +1110,505 @@ TEST_F(TestNeuralNetwork, NeuralNetwork) {
 }
 
 
+TEST_F(TestNeuralNetwork, SharedSubgraphEvaluatedOnce) {
+    // ReLU that counts how often it runs
+    struct CountingReLU : public ReLUOperation {
+        using ReLUOperation::ReLUOperation;
+        using ReLUOperation::compute;
+        mutable int calls = 0;
+        void compute(const Tensor& input, Tensor& output) const override {
+            ++calls;
+            ReLUOperation::compute(input, output);
+        }
+    };
+
+    NeuralNetwork nn;
+    t2 = nullptr;
+
+    const auto& input_node = std::make_shared<InputData>(*t1);
+    const auto& relu_op = std::make_shared<CountingReLU>(input_node);
+    nn.addOp(relu_op);
+
+    // Diamond: relu feeds both branches of the add, then a residual on top
+    const auto& branch_op = std::make_shared<ScalarAddOperation>(relu_op, relu_op);
+    nn.addOp(branch_op);
+    const auto& residual_op = std::make_shared<ScalarAddOperation>(branch_op, relu_op);
+    nn.addOp(residual_op);
+
+    Tensor output = nn.infer();
+    EXPECT_EQ(relu_op->calls, 1);
+
+    for (size_t i = 0; i < output.size(); ++i) {
+        EXPECT_NEAR(output.at(i), 3.0f * t1->at(i), 1e-5);
+    }
+
+    // The recursive path still agrees
+    Tensor recursive = residual_op->evaluate();
+    for (size_t i = 0; i < output.size(); ++i) {
+        EXPECT_NEAR(output.at(i), recursive.at(i), 1e-6);
+    }
+}
+
+
+TEST_F(TestNeuralNetwork, MemoryPlanReusesBuffers) {
+    NeuralNetwork nn;
+    t2 = nullptr;
+
+    // Chain of same-shaped elementwise ops: each one runs in place over its operand
+    const auto& input_node = std::make_shared<InputData>(*t1);
+    std::shared_ptr<INode> last = input_node;
+    for (int i = 0; i < 6; ++i) {
+        last = nn.addOp(std::make_shared<ScalarAddOperation>(last, *t1));
+    }
+
+    const MemoryPlan& plan = nn.memoryPlan();
+    const size_t tensor_bytes = 16 * sizeof(float); // 12 floats, aligned to 64 bytes
+    EXPECT_EQ(plan.unplanned_bytes(), 6 * tensor_bytes);
+    EXPECT_EQ(plan.peak_bytes(), tensor_bytes);
+
+    for (int run = 0; run < 2; ++run) {
+        Tensor output = nn.infer();
+        for (size_t i = 0; i < output.size(); ++i) {
+            EXPECT_NEAR(output.at(i), 7.0f * t1->at(i), 1e-5);
+        }
+    }
+
+    // A new input shape triggers a new plan, which checks shapes again
+    input_node->setTensor(Tensor(1, 3, 2, 3));
+    EXPECT_THROW(nn.infer(), std::invalid_argument);
+}
+
+
+TEST_F(TestNeuralNetwork, InPlaceElementwise) {
+    t2 = new Tensor({1, 3, 2, 2}, RandomVector(12, 29));
+
+    // Kernels agree with the scalar reference on every tail length, out aliasing a
+    const std::vector<float> a = RandomVector(77, 30), b = RandomVector(77, 31);
+    for (size_t n : {0, 1, 7, 16, 31, 77}) {
+        for (ElementwiseOp op : {ElementwiseOp::Add, ElementwiseOp::Sub, ElementwiseOp::Mul}) {
+            std::vector<float> out(a.begin(), a.begin() + n);
+            Elementwise::Binary(op, out.data(), b.data(), out.data(), n, true);
+            for (size_t i = 0; i < n; ++i) {
+                const float value = op == ElementwiseOp::Add ? a[i] + b[i] : op == ElementwiseOp::Sub ? a[i] - b[i] : a[i] * b[i];
+                EXPECT_EQ(out[i], std::max(0.0f, value));
+            }
+        }
+    }
+
+    // x feeds both the ReLU and the final add, so only the add may write over it
+    const auto& input_node = std::make_shared<InputData>(*t1);
+    const auto& x = std::make_shared<ScalarMulOperation>(input_node, *t2);
+    const auto& y = std::make_shared<ReLUOperation>(std::make_shared<ScalarSubOperation>(x, *t2));
+    const auto& z = std::make_shared<ReLUOperation>(std::make_shared<ScalarAddOperation>(y, x));
+    const Tensor reference = z->evaluate();
+
+    Executor executor({z.get()});
+    const MemoryPlan plan = MemoryPlanner::Plan(executor);
+    EXPECT_NE(plan.offsets[1], plan.offsets[2]);  // sub keeps x
+    EXPECT_EQ(plan.offsets[2], plan.offsets[3]);  // relu over sub
+    EXPECT_EQ(plan.offsets[4], plan.offsets[3]);  // add over relu, the first operand
+    EXPECT_EQ(plan.offsets[5], plan.offsets[4]);  // relu over add
+    EXPECT_EQ(plan.peak_bytes(), 2 * 16 * sizeof(float));
+
+    Tensor arena({plan.arena_size}, Tensor::Uninitialized());
+    std::vector<Tensor> slots = executor.bind(plan, arena.data());
+    executor.run(slots);
+    const Tensor allocated = executor.run().front();
+    for (size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(executor.result(slots, executor.outputs().front()).at(i), reference.at(i), 1e-6);
+        EXPECT_NEAR(allocated.at(i), reference.at(i), 1e-6);
+    }
+}
+
+
+TEST_F(TestNeuralNetwork, CompiledExecutionPlan) {
+    NeuralNetwork nn;
+    t2 = new Tensor({1, 3, 2, 2}, RandomVector(12, 32));
+    const Tensor weights({1, 3, 2, 2}, RandomVector(12, 33));
+    const Tensor bias({1, 3, 2, 2}, RandomVector(12, 34));
+
+    const auto& input_node = std::make_shared<InputData>(*t1);
+    const auto& x = nn.addOp(std::make_shared<ScalarMulOperation>(input_node, *t2));
+    const auto& y = nn.addOp(std::make_shared<ReLUOperation>(nn.addOp(std::make_shared<ScalarSubOperation>(x, *t2))));
+    const auto& z = nn.addOp(std::make_shared<ScalarAddOperation>(y, x));
+    const auto& mm = nn.addOp(std::make_shared<MatMulOperation>(z, weights));
+    const auto& biased = nn.addOp(std::make_shared<ReLUOperation>(nn.addOp(std::make_shared<ScalarAddOperation>(mm, bias))));
+    nn.addOp(std::make_shared<SoftmaxOperation>(biased, 3));
+
+    const std::shared_ptr<const ExecutionPlan> plan = nn.compile();
+    EXPECT_EQ(plan->ops().size(), 6u);  // bias add and ReLU fused into the MatMul
+    EXPECT_EQ(plan->directOps(), 4u);   // mul, sub, ReLU, add
+
+    for (unsigned seed : {35, 36}) {
+        const Tensor expected = nn.infer();
+        const Tensor& output = plan->run();
+        ASSERT_EQ(output.shape(), expected.shape());
+        for (size_t i = 0; i < expected.size(); ++i) EXPECT_NEAR(output.at(i), expected.at(i), 1e-6);
+        // New input values of the same shape run on the same plan
+        input_node->setTensor(Tensor({1, 3, 2, 2}, RandomVector(12, seed)));
+    }
+
+    // The plan keeps the graph alive, but not across input shape changes
+    nn.clear();
+    EXPECT_NO_THROW(plan->run());
+    input_node->setTensor(Tensor(1, 3, 2, 3));
+    EXPECT_THROW(plan->run(), std::invalid_argument);
+}
+
+
+TEST_F(TestNeuralNetwork, MappedModelFile) {
+    NeuralNetwork nn;
+    t2 = nullptr;
+    const auto& input_node = std::make_shared<InputData>(Tensor({1, 3, 6, 6}, RandomVector(108, 37)));
+    const auto& conv = nn.addOp(std::make_shared<ConvolOperation>(input_node, Tensor({4, 3, 3, 3}, RandomVector(108, 38)), 1, 1));
+    const auto& biased = nn.addOp(std::make_shared<ScalarAddOperation>(conv, Tensor({1, 4, 6, 6}, RandomVector(144, 39))));
+    const auto& relu = nn.addOp(std::make_shared<ReLUOperation>(biased));
+    const auto& mm = nn.addOp(std::make_shared<MatMulOperation>(relu, Tensor({1, 4, 6, 5}, RandomVector(120, 40))));
+    nn.addOp(std::make_shared<SoftmaxOperation>(mm, 3));
+    nn.setWeightType(DType::BF16);
+    const Tensor expected = nn.infer();
+
+    const std::string path = ::testing::TempDir() + "mapped_model.nnm";
+    ModelFile::Save(nn, path);
+    NeuralNetwork loaded = ModelFile::Load(path);
+    const Tensor output = loaded.infer();
+    ASSERT_EQ(output.shape(), expected.shape());
+    for (size_t i = 0; i < expected.size(); ++i) EXPECT_NEAR(output.at(i), expected.at(i), 1e-6);
+
+    // Weights stay in the mapped file, 64-byte aligned, in their stored type
+    size_t mapped = 0;
+    for (const std::shared_ptr<INode>& op : loaded.getOperations()) {
+        const auto* binary = dynamic_cast<const BinaryOperation*>(op.get());
+        if (!binary || !binary->rhsTensor()) continue;
+        const Tensor& weights = *binary->rhsTensor();
+        EXPECT_TRUE(weights.is_external());
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(op->kind() == OpKind::Add ? weights.data() : static_cast<const void*>(weights.halfData())) % 64, 0u);
+        EXPECT_EQ(weights.dtype(), op->kind() == OpKind::Add ? DType::F32 : DType::BF16);
+        ++mapped;
+    }
+    EXPECT_EQ(mapped, 3u);
+
+    // Inputs come back as InputData nodes that take new values
+    auto* loaded_input = dynamic_cast<InputData*>(loaded.getOperations().front().get());
+    ASSERT_NE(loaded_input, nullptr);
+    const Tensor next({1, 3, 6, 6}, RandomVector(108, 41));
+    input_node->setTensor(next);
+    loaded_input->setTensor(next);
+    const Tensor expected_next = nn.infer();
+    const std::shared_ptr<const ExecutionPlan> plan = loaded.compile();
+    const Tensor& output_next = plan->run();
+    for (size_t i = 0; i < expected_next.size(); ++i) EXPECT_NEAR(output_next.at(i), expected_next.at(i), 1e-6);
+
+    // Truncated files are rejected
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), 100);
+    }
+    EXPECT_THROW(ModelFile::Load(path), std::invalid_argument);
+    std::remove(path.c_str());
+}
+
+
+TEST_F(TestNeuralNetwork, AheadOfTimeCodeGen) {
+    NeuralNetwork nn;
+    t2 = nullptr;
+    const std::shared_ptr<InputData> input_node = BuildAotModel(nn);
+
+    // Elementwise steps become direct kernel calls, the rest typed operation calls
+    const std::string source = CodeGen::Emit(nn);
+    EXPECT_NE(source.find("Elementwise::Binary(ElementwiseOp::Mul"), std::string::npos);
+    EXPECT_NE(source.find("Epilogue{"), std::string::npos);
+    EXPECT_NE(source.find("SoftmaxOperation op"), std::string::npos);
+
+    for (unsigned seed : {42, 43}) {
+        const Tensor input({1, 3, 8, 8}, RandomVector(192, seed));
+        input_node->setTensor(input);
+        const Tensor expected = nn.infer();
+        ASSERT_EQ(etc_aot_embedded_output_size(), expected.size());
+
+        const float* inputs[] = {input.data()};
+        for (auto* model : {&etc_aot_embedded, &etc_aot_mapped}) {
+            std::vector<float> output(expected.size(), -1.0f);
+            model(inputs, output.data());
+            for (size_t i = 0; i < expected.size(); ++i) EXPECT_NEAR(output[i], expected.at(i), 1e-6);
+        }
+    }
+}
+
+
+TEST_F(TestNeuralNetwork, Int8Calibration) {
+    NeuralNetwork nn;
+    t2 = new Tensor({16, 3, 3, 3}, RandomVector(432, 46));
+    Tensor kernel2({8, 16, 1, 1}, RandomVector(128, 47));
+    Tensor bias({1, 8, 1, 1}, RandomVector(8, 48));
+    Tensor input({1, 3, 12, 12}, RandomVector(432, 49));
+    const auto input_node = std::make_shared<InputData>(input);
+
+    const auto& conv1 = nn.addOp(std::make_shared<ConvolOperation>(input_node, *t2, 1, 1));
+    const auto& relu = nn.addOp(std::make_shared<ReLUOperation>(conv1));
+    const auto& conv2 = nn.addOp(std::make_shared<ConvolOperation>(relu, kernel2, 1, 0));
+    nn.addOp(std::make_shared<ScalarAddOperation>(conv2, bias));
+    const Tensor reference = nn.infer();
+
+    std::vector<Tensor> samples;
+    for (unsigned seed = 50; seed < 54; ++seed) samples.emplace_back(input.shape(), RandomVector(input.size(), seed));
+    EXPECT_EQ(nn.quantize(*input_node, samples), 2u);
+    EXPECT_TRUE(std::static_pointer_cast<ConvolOperation>(conv2)->getQuantization().has_value());
+    EXPECT_EQ(input_node->value()->data()[0], input.data()[0]);
+
+    // Calibrated ranges cover this input too: int8 results track fp32 closely
+    const Tensor output = nn.infer();
+    ASSERT_EQ(output.shape(), reference.shape());
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < reference.size(); ++i) max_abs = std::max(max_abs, std::fabs(reference.at(i)));
+    for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), 0.03f * max_abs);
+    EXPECT_THROW(nn.quantize(*input_node, {}), std::invalid_argument);
+}
+
+
+TEST_F(TestNeuralNetwork, HalfPrecisionWeights) {
+    NeuralNetwork nn;
+    t2 = new Tensor({16, 8, 3, 3}, RandomVector(1152, 55));
+    Tensor kernel1({8, 3, 3, 3}, RandomVector(216, 56));
+    Tensor bias({1, 16, 1, 1}, RandomVector(16, 57));
+    Tensor input({2, 3, 10, 10}, RandomVector(600, 58));
+    const auto input_node = std::make_shared<InputData>(input);
+
+    const auto& conv1 = nn.addOp(std::make_shared<ConvolOperation>(input_node, kernel1, 1, 1));
+    const auto& relu = nn.addOp(std::make_shared<ReLUOperation>(conv1));
+    const auto& conv2 = nn.addOp(std::make_shared<ConvolOperation>(relu, *t2, 1, 1));
+    nn.addOp(std::make_shared<ScalarAddOperation>(conv2, bias));
+    const Tensor reference = nn.infer();
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < reference.size(); ++i) max_abs = std::max(max_abs, std::fabs(reference.at(i)));
+
+    // A 16-bit graph input is widened by the convolution reading it
+    input_node->setTensor(input.toDType(DType::F16));
+    Tensor output = nn.infer();
+    for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), 2e-3f * max_abs);
+    input_node->setTensor(input);
+
+    // Each conversion rounds the current weights, so the coarser type goes last
+    for (DType dtype : {DType::F16, DType::BF16}) {
+        nn.setWeightType(dtype);
+        EXPECT_EQ(std::static_pointer_cast<ConvolOperation>(conv2)->rhsTensor()->dtype(), dtype);
+        const float tolerance = (dtype == DType::BF16 ? 2e-2f : 2e-3f) * max_abs;
+        output = nn.infer();
+        ASSERT_EQ(output.shape(), reference.shape());
+        for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), tolerance) << DTypeName(dtype);
+    }
+}
+
+
+TEST_F(TestNeuralNetwork, BroadcastBias) {
+    NeuralNetwork nn;
+    t2 = new Tensor({4, 3, 3, 3}, RandomVector(108, 36));
+    Tensor bias({1, 4, 1, 1}, RandomVector(4, 37));
+    Tensor input({2, 3, 6, 20}, RandomVector(720, 38));
+    const auto& input_node = std::make_shared<InputData>(input);
+    const GemmBackend default_backend = FastMatMul::GetBackend();
+
+    // Conv -> per-channel bias -> ReLU: the bias is read as 4 floats by the GEMM store
+    const auto conv = std::make_shared<ConvolOperation>(input_node, *t2, 1, 1);
+    nn.addOp(conv);
+    const auto& add = nn.addOp(std::make_shared<ScalarAddOperation>(conv, bias));
+    const auto& relu = nn.addOp(std::make_shared<ReLUOperation>(add));
+    Executor executor({relu.get()});
+    EXPECT_EQ(EpilogueFusion::Apply(executor), 2u);
+
+    // Every algorithm and kernel, NCHW and blocked
+    const Tensor reference = relu->evaluate();
+    for (GemmBackend backend : {GemmBackend::Scalar, GemmBackend::Neon, GemmBackend::Avx2, GemmBackend::Avx512}) {
+        if (!FastMatMul::IsBackendAvailable(backend)) continue;
+        FastMatMul::SetBackend(backend);
+        for (ConvAlgorithm algorithm : {ConvAlgorithm::Auto, ConvAlgorithm::Im2Col, ConvAlgorithm::Winograd2x2, ConvAlgorithm::Winograd4x4}) {
+            conv->setAlgorithm(algorithm);
+            for (Layout blocked : {Layout::NCHW, LayoutAssignment::PreferredBlockedLayout()}) {
+                nn.setBlockedLayout(blocked);
+                const Tensor output = nn.infer();
+                ASSERT_EQ(output.shape(), reference.shape());
+                for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), 1e-4) << FastMatMul::BackendName(backend);
+            }
+        }
+
+        // The int8 store matches its own unfused result
+        ConvolOperation int8_conv(input_node, *t2, 1, 1);
+        QuantParams activation;
+        activation.scale = 2.0f / 255.0f;
+        activation.zero_point = 0;
+        int8_conv.setQuantization(activation);
+        Tensor expected = int8_conv.evaluate();
+        for (size_t i = 0; i < expected.size(); ++i) expected.at(i) = std::max(0.0f, expected.at(i) + bias.at(i / (6 * 20) % 4));
+        Epilogue epilogue;
+        epilogue.addend = &bias;
+        epilogue.relu = true;
+        Tensor fused(expected.shape(), Tensor::Uninitialized());
+        int8_conv.compute(input, *int8_conv.rhsTensor(), fused, epilogue);
+        for (size_t i = 0; i < fused.size(); ++i) EXPECT_NEAR(fused.at(i), expected.at(i), 1e-5) << FastMatMul::BackendName(backend);
+    }
+    FastMatMul::SetBackend(default_backend);
+}
+
+
+TEST_F(TestNeuralNetwork, EpilogueFusion) {
+    t2 = new Tensor({1, 3, 2, 2}, RandomVector(12, 5));
+    const auto& input_node = std::make_shared<InputData>(*t1);
+
+    // MatMul -> Add(node computed after the MatMul) -> ReLU
+    const auto& matmul_op = std::make_shared<MatMulOperation>(input_node, *t2);
+    const auto& bias_op = std::make_shared<ReLUOperation>(std::make_shared<ScalarSubOperation>(input_node, *t2));
+    const auto& add_op = std::make_shared<ScalarAddOperation>(matmul_op, bias_op);
+    const auto& relu_op = std::make_shared<ReLUOperation>(add_op);
+
+    // Conv -> Add(constant) -> ReLU
+    Tensor kernel({2, 3, 1, 1}, RandomVector(6, 6));
+    const auto& conv_op = std::make_shared<ConvolOperation>(relu_op, kernel, 1, 0);
+    Tensor conv_bias({1, 2, 2, 2}, RandomVector(8, 7));
+    const auto& conv_add_op = std::make_shared<ScalarAddOperation>(conv_bias, conv_op);
+    const auto& conv_relu_op = std::make_shared<ReLUOperation>(conv_add_op);
+
+    Executor executor({conv_relu_op.get()});
+    EXPECT_EQ(EpilogueFusion::Apply(executor), 4u);
+
+    NeuralNetwork nn;
+    for (const auto& op : std::vector<std::shared_ptr<INode>>{matmul_op, bias_op, add_op, relu_op, conv_op, conv_add_op, conv_relu_op}) {
+        nn.addOp(op);
+    }
+    Tensor fused = nn.infer();
+    Tensor reference = conv_relu_op->evaluate();
+
+    ASSERT_EQ(fused.shape(), reference.shape());
+    for (size_t i = 0; i < fused.size(); ++i) {
+        EXPECT_NEAR(fused.at(i), reference.at(i), 1e-5);
+    }
+}
+
+
+TEST_F(TestNeuralNetwork, InterOpParallelBranches) {
+    NeuralNetwork nn;
+    t2 = new Tensor({1, 3, 2, 2}, RandomVector(12, 8));
+    const auto& input_node = std::make_shared<InputData>(*t1);
+
+    // Four independent two-step branches, summed pairwise
+    std::vector<std::shared_ptr<INode>> branches;
+    for (int b = 0; b < 4; ++b) {
+        auto head = nn.addOp(std::make_shared<ScalarMulOperation>(input_node, *t2));
+        auto tail = b % 2 ? nn.addOp(std::make_shared<ReLUOperation>(head))
+                          : nn.addOp(std::make_shared<MatMulOperation>(head, *t2));
+        branches.push_back(tail);
+    }
+    auto left = nn.addOp(std::make_shared<ScalarAddOperation>(branches[0], branches[1]));
+    auto right = nn.addOp(std::make_shared<ScalarAddOperation>(branches[2], branches[3]));
+    auto sum = nn.addOp(std::make_shared<ScalarSubOperation>(left, right));
+
+    const Tensor sequential = nn.infer();
+    const size_t sequential_peak = nn.memoryPlan().peak_bytes();
+
+    nn.setInterOpThreads(4);
+    EXPECT_EQ(nn.getInterOpThreads(), 4u);
+
+    // Branches may now be live together, so they must not share storage
+    EXPECT_GE(nn.memoryPlan().peak_bytes(), sequential_peak);
+    for (int run = 0; run < 3; ++run) {
+        Tensor parallel = nn.infer();
+        ASSERT_EQ(parallel.shape(), sequential.shape());
+        for (size_t i = 0; i < parallel.size(); ++i) {
+            EXPECT_NEAR(parallel.at(i), sequential.at(i), 1e-5);
+        }
+    }
+
+    // Errors inside a step reach the caller
+    input_node->setTensor(Tensor(2, 3, 2, 2));
+    EXPECT_THROW(nn.infer(), std::invalid_argument);
+}
+
+
+TEST_F(TestNeuralNetwork, PooledAlignedStorage) {
+    // Pool that counts what reaches the heap
+    struct CountingAllocator : public Allocator {
+        size_t allocations = 0;
+        void* Allocate(size_t bytes) override {
+            ++allocations;
+            return AlignedAllocator::Shared().Allocate(bytes);
+        }
+        void Deallocate(void* ptr, size_t bytes) override { AlignedAllocator::Shared().Deallocate(ptr, bytes); }
+    } heap;
+    PoolAllocator pool(heap);
+    Allocator::SetDefault(&pool);
+
+    {
+        NeuralNetwork nn;
+        t2 = new Tensor({1, 3, 2, 2}, RandomVector(12, 13));
+        const auto& input_node = std::make_shared<InputData>(*t1);
+        const auto& matmul_op = nn.addOp(std::make_shared<MatMulOperation>(input_node, *t2));
+        nn.addOp(std::make_shared<ReLUOperation>(std::make_shared<ScalarAddOperation>(matmul_op, *t2)));
+
+        Tensor first = nn.infer();
+        EXPECT_EQ(first.allocator(), &pool);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(first.data()) % Allocator::kAlignment, 0u);
+
+        // Once warm, runs recycle the buffers of earlier results
+        nn.infer();
+        const size_t warm = heap.allocations;
+        for (int run = 0; run < 3; ++run) {
+            Tensor output = nn.infer();
+            for (size_t i = 0; i < output.size(); ++i) EXPECT_EQ(output.at(i), first.at(i));
+        }
+        EXPECT_EQ(heap.allocations, warm);
+        EXPECT_GT(pool.hits(), 0u);
+
+        Tensor scratch({3, 5}, Tensor::Uninitialized(), &heap);
+        EXPECT_EQ(scratch.allocator(), &heap);
+        EXPECT_EQ(scratch.size(), 15u);
+    }
+    delete t2;
+    t2 = nullptr;
+    Allocator::SetDefault(nullptr);
+
+    EXPECT_EQ(PoolAllocator::SizeClass(1), 64u);
+    EXPECT_EQ(PoolAllocator::SizeClass(1000), 1024u);
+    EXPECT_EQ(PoolAllocator::SizeClass(4097), 5120u);
+}
+
+
+TEST_F(TestNeuralNetwork, BlockedLayoutPass) {
+    t2 = nullptr;
+    Tensor image({1, 6, 12, 20}, RandomVector(1440, 23));
+    Tensor kernel1({16, 6, 3, 3}, RandomVector(864, 24));
+    Tensor bias1({1, 16, 12, 20}, RandomVector(3840, 25));
+    Tensor kernel2({16, 16, 3, 3}, RandomVector(2304, 26));
+    Tensor kernel3({8, 16, 1, 1}, RandomVector(128, 27));
+
+    // conv -> add -> relu -> conv -> add(residual) -> conv -> softmax
+    const auto input = std::make_shared<InputData>(image);
+    const auto conv1 = std::make_shared<ConvolOperation>(input, kernel1, 1, 1);
+    const auto relu1 = std::make_shared<ReLUOperation>(std::make_shared<ScalarAddOperation>(conv1, bias1));
+    const auto conv2 = std::make_shared<ConvolOperation>(relu1, kernel2, 1, 1);
+    const auto residual = std::make_shared<ScalarAddOperation>(conv2, relu1);
+    const auto conv3 = std::make_shared<ConvolOperation>(residual, kernel3, 1, 0);
+    const auto softmax = std::make_shared<SoftmaxOperation>(conv3);
+    const Tensor reference = softmax->evaluate();
+
+    NeuralNetwork nn;
+    for (const auto& op : std::vector<std::shared_ptr<INode>>{conv1, relu1, conv2, residual, conv3, softmax}) nn.addOp(op);
+    for (Layout layout : {Layout::NCHW8c, Layout::NCHW16c, Layout::NCHW}) {
+        nn.setBlockedLayout(layout);
+        const Tensor output = nn.infer();
+        ASSERT_EQ(output.layout(), Layout::NCHW);
+        ASSERT_EQ(output.shape(), reference.shape());
+        for (size_t i = 0; i < output.size(); ++i) EXPECT_NEAR(output.at(i), reference.at(i), 1e-4) << LayoutName(layout);
+
+        // The conv stack stays blocked: one reorder in, one out for the softmax
+        const MemoryPlan& plan = nn.memoryPlan();
+        const size_t blocked = std::count(plan.layouts.begin(), plan.layouts.end(), layout);
+        if (layout == Layout::NCHW) continue;
+        EXPECT_EQ(blocked, 4u) << LayoutName(layout); // the input reorder and 3 convs with their fused tails
+    }
+    EXPECT_THROW(nn.setBlockedLayout(Layout::NHWC), std::invalid_argument);
+}
+
+
 // ------------------------------- MAIN -------------------------------
 
 